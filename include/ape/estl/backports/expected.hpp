@@ -0,0 +1,258 @@
+#pragma once
+
+#ifndef APE_ESTL_BACKPORTS_EXPECTED_H
+#define APE_ESTL_BACKPORTS_EXPECTED_H
+
+/// reference: https://en.cppreference.com/w/cpp/utility/expected
+
+#include <ape/config.hpp>
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202202L
+#include <expected>
+BEGIN_APE_NAMESPACE
+namespace stl{
+    using std::expected;
+    using std::unexpected;
+    using std::bad_expected_access;
+    using std::unexpect_t;
+    using std::unexpect;
+}
+END_APE_NAMESPACE
+#else
+
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+BEGIN_APE_NAMESPACE
+namespace stl{
+
+template <typename E>
+class unexpected
+{
+public:
+    constexpr explicit unexpected(const E &e) : m_error(e) {}
+    constexpr explicit unexpected(E &&e) : m_error(std::move(e)) {}
+
+    constexpr const E &error() const & noexcept { return m_error; }
+    constexpr E &error() & noexcept { return m_error; }
+    constexpr E &&error() && noexcept { return std::move(m_error); }
+
+private:
+    E m_error;
+};
+
+template <typename E>
+unexpected(E) -> unexpected<E>;
+
+struct unexpect_t
+{
+    explicit unexpect_t() = default;
+};
+inline constexpr unexpect_t unexpect{};
+
+template <typename E>
+class bad_expected_access : public std::exception
+{
+public:
+    explicit bad_expected_access(E e) : m_error(std::move(e)) {}
+    const char *what() const noexcept override { return "bad expected access"; }
+    const E &error() const & noexcept { return m_error; }
+
+private:
+    E m_error;
+};
+
+/// Subset of std::expected: construction, observers and value_or, without monadic operations.
+template <typename T, typename E>
+class expected
+{
+public:
+    using value_type = T;
+    using error_type = E;
+    using unexpected_type = unexpected<E>;
+
+    constexpr expected() requires std::is_default_constructible_v<T> : m_value(), m_has_value(true) {}
+
+    template <typename U = T>
+        requires(!std::is_same_v<std::remove_cvref_t<U>, expected> &&
+                 !std::is_same_v<std::remove_cvref_t<U>, unexpected<E>> && std::is_constructible_v<T, U>)
+    constexpr expected(U &&v) : m_value(std::forward<U>(v)), m_has_value(true) {}
+
+    template <typename G>
+    constexpr expected(const unexpected<G> &e) : m_error(e.error()), m_has_value(false) {}
+    template <typename G>
+    constexpr expected(unexpected<G> &&e) : m_error(std::move(e).error()), m_has_value(false) {}
+
+    template <typename... Args>
+    constexpr explicit expected(unexpect_t, Args &&...args) : m_error(std::forward<Args>(args)...), m_has_value(false) {}
+
+    constexpr expected(const expected &rhs) requires(std::is_trivially_copy_constructible_v<T> &&
+                                                      std::is_trivially_copy_constructible_v<E>) = default;
+    constexpr expected(const expected &rhs) : m_has_value(rhs.m_has_value)
+    {
+        if (m_has_value)
+            std::construct_at(std::addressof(m_value), rhs.m_value);
+        else
+            std::construct_at(std::addressof(m_error), rhs.m_error);
+    }
+
+    constexpr expected(expected &&rhs) requires(std::is_trivially_move_constructible_v<T> &&
+                                                 std::is_trivially_move_constructible_v<E>) = default;
+    constexpr expected(expected &&rhs) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                std::is_nothrow_move_constructible_v<E>)
+        : m_has_value(rhs.m_has_value)
+    {
+        if (m_has_value)
+            std::construct_at(std::addressof(m_value), std::move(rhs.m_value));
+        else
+            std::construct_at(std::addressof(m_error), std::move(rhs.m_error));
+    }
+
+    constexpr expected &operator=(const expected &rhs)
+    {
+        if (this != &rhs)
+        {
+            destroy();
+            std::construct_at(this, rhs);
+        }
+        return *this;
+    }
+    constexpr expected &operator=(expected &&rhs) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                           std::is_nothrow_move_constructible_v<E>)
+    {
+        if (this != &rhs)
+        {
+            destroy();
+            std::construct_at(this, std::move(rhs));
+        }
+        return *this;
+    }
+
+    constexpr ~expected() requires(std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>) = default;
+    constexpr ~expected() { destroy(); }
+
+    constexpr bool has_value() const noexcept { return m_has_value; }
+    constexpr explicit operator bool() const noexcept { return m_has_value; }
+
+    constexpr const T &operator*() const & noexcept { return m_value; }
+    constexpr T &operator*() & noexcept { return m_value; }
+    constexpr T &&operator*() && noexcept { return std::move(m_value); }
+    constexpr const T *operator->() const noexcept { return std::addressof(m_value); }
+    constexpr T *operator->() noexcept { return std::addressof(m_value); }
+
+    constexpr const T &value() const &
+    {
+        if (!m_has_value)
+            throw bad_expected_access<E>(m_error);
+        return m_value;
+    }
+    constexpr T &value() &
+    {
+        if (!m_has_value)
+            throw bad_expected_access<E>(m_error);
+        return m_value;
+    }
+    constexpr T &&value() &&
+    {
+        if (!m_has_value)
+            throw bad_expected_access<E>(m_error);
+        return std::move(m_value);
+    }
+
+    constexpr const E &error() const & noexcept { return m_error; }
+    constexpr E &error() & noexcept { return m_error; }
+
+    template <typename U>
+    constexpr T value_or(U &&v) const &
+    {
+        return m_has_value ? m_value : static_cast<T>(std::forward<U>(v));
+    }
+
+private:
+    constexpr void destroy() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T> || !std::is_trivially_destructible_v<E>)
+        {
+            if (m_has_value)
+                std::destroy_at(std::addressof(m_value));
+            else
+                std::destroy_at(std::addressof(m_error));
+        }
+    }
+
+    union
+    {
+        T m_value;
+        E m_error;
+    };
+    bool m_has_value;
+};
+
+template <typename E>
+class expected<void, E>
+{
+public:
+    using value_type = void;
+    using error_type = E;
+    using unexpected_type = unexpected<E>;
+
+    constexpr expected() noexcept : m_has_value(true) {}
+
+    template <typename G>
+    constexpr expected(const unexpected<G> &e) : m_error(e.error()), m_has_value(false) {}
+    template <typename G>
+    constexpr expected(unexpected<G> &&e) : m_error(std::move(e).error()), m_has_value(false) {}
+
+    constexpr expected(const expected &rhs) : m_has_value(rhs.m_has_value)
+    {
+        if (!m_has_value)
+            std::construct_at(std::addressof(m_error), rhs.m_error);
+    }
+    constexpr expected &operator=(const expected &rhs)
+    {
+        if (this != &rhs)
+        {
+            destroy();
+            std::construct_at(this, rhs);
+        }
+        return *this;
+    }
+    constexpr ~expected() { destroy(); }
+
+    constexpr bool has_value() const noexcept { return m_has_value; }
+    constexpr explicit operator bool() const noexcept { return m_has_value; }
+    constexpr void operator*() const noexcept {}
+
+    constexpr void value() const
+    {
+        if (!m_has_value)
+            throw bad_expected_access<E>(m_error);
+    }
+
+    constexpr const E &error() const & noexcept { return m_error; }
+    constexpr E &error() & noexcept { return m_error; }
+
+private:
+    constexpr void destroy() noexcept
+    {
+        if (!m_has_value)
+            std::destroy_at(std::addressof(m_error));
+    }
+
+    union
+    {
+        E m_error;
+    };
+    bool m_has_value;
+};
+
+}
+END_APE_NAMESPACE
+
+#endif
+#endif // end APE_ESTL_BACKPORTS_EXPECTED_H
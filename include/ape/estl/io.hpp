@@ -4,4 +4,19 @@
 #include <ape/estl/io/iocore.hpp>
 #include <ape/estl/io/memory.hpp>
 #include <ape/estl/io/adaptor.hpp>
+#include <ape/estl/io/buffered.hpp>
+#include <ape/estl/io/cache.hpp>
+#include <ape/estl/io/algorithm.hpp>
+#include <ape/estl/io/sparse.hpp>
+#include <ape/estl/io/any_device.hpp>
+#include <ape/estl/io/metered.hpp>
+#include <ape/estl/io/pipe.hpp>
+#include <ape/estl/io/readahead.hpp>
+#include <ape/estl/io/async.hpp>
+#if __has_include(<unistd.h>)
+#include <ape/estl/io/file.hpp>
+#include <ape/estl/io/mapped_file.hpp>
+#include <ape/estl/io/async_file.hpp>
+#include <ape/estl/io/direct_file.hpp>
+#endif
 #endif // end  APE_ESTL_IO_H
\ No newline at end of file
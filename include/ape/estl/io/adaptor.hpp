@@ -2,6 +2,12 @@
 #ifndef APE_ESTL_IO_ADAPTOR_H
 #define APE_ESTL_IO_ADAPTOR_H
 #include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 BEGIN_APE_NAMESPACE
@@ -13,14 +19,18 @@ namespace io
         MultiplexDevice *self;
         offset_tracker(MultiplexDevice *me) : self(me)
         {
-            seek(self->m_device, self->pos);
+            io::seek(self->m_device, self->pos);
         }
         ~offset_tracker()
         {
-            self->pos = offset(self->m_device);
+            self->pos = io::offset(self->m_device);
         }
     };
 
+    // Several multiplex_device can share one underlying device, each with its own offset.
+    // When the device supports positional io (read_at/write_at), transfers never touch the
+    // shared device offset, so multiplexers of a thread safe device can be used concurrently.
+    // Otherwise, or where io::supports denies positional io, every operation seeks the shared device first.
     template <random Device>
     class multiplex_device
     {
@@ -39,22 +49,38 @@ namespace io
             return pos;
         }
 
-        bool is_eof(error_code_ptr ec = {}) const noexcept
+        bool is_eof(error_code_ptr ec = {}) const
         {
-            offset_tracker tracker{this};
-            return is_eof(m_device, ec);
+            if constexpr (sizer<Device>)
+            {
+                if (io::supports(m_device, device_caps::sizer))
+                {
+                    auto s = io::size(m_device, ec);
+                    return has_error(ec) || pos >= s;
+                }
+            }
+            offset_tracker tracker{const_cast<multiplex_device *>(this)};
+            return io::is_eof(m_device, ec);
         }
 
         long_size_t seek(long_size_t offset, error_code_ptr ec = {})
         {
-            offset_tracker tracker{this};
+            if constexpr (positional_reader<Device> || positional_writer<Device>)
+            {
+                clear_error(ec);
+                return pos = offset;
+            }
+            else
+            {
+                offset_tracker tracker{this};
 
-            return seek(m_device, offset, ec);
+                return io::seek(m_device, offset, ec);
+            }
         }
 
-        long_size_t size(error_code_ptr ec = {}) const noexcept
+        long_size_t size(error_code_ptr ec = {}) const
         {
-            return size(m_device, ec);
+            return io::size(m_device, ec);
         }
 
         Device& underlying() noexcept
@@ -68,38 +94,73 @@ namespace io
 
         mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
         {
+            if constexpr (positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_reader))
+                {
+                    auto res = io::read_at(m_device, pos, buf, ec);
+                    pos += res.size();
+                    return res;
+                }
+            }
             offset_tracker tracker{this};
+            return io::read(m_device, buf, ec);
+        }
 
-            return read(m_device, buf, ec);
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+            requires positional_reader<Device>
+        {
+            return io::read_at(m_device, off, buf, ec);
         }
 
         auto view_rd(long_offset_range h, error_code_ptr ec = {})
         {
-            return view_rd(m_device, h, ec);
+            return io::view_rd(m_device, h, ec);
         }
 
         const_buffer write(const_buffer buf, error_code_ptr ec = {})
         {
+            if constexpr (positional_writer<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_writer))
+                {
+                    auto res = io::write_at(m_device, pos, buf, ec);
+                    pos += buf.size() - res.size();
+                    return res;
+                }
+            }
             offset_tracker tracker{this};
+            return io::write(m_device, buf, ec);
+        }
 
-            return write(m_device, buf, ec);
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+            requires positional_writer<Device>
+        {
+            return io::write_at(m_device, off, buf, ec);
         }
 
         auto view_wr(long_offset_range h, error_code_ptr ec = {})
         {
-            return view_wr(m_device, h, ec);
+            return io::view_wr(m_device, h, ec);
         }
 
         void sync(error_code_ptr err = {})
         {
-            sync(m_device, err);
+            io::sync(m_device, err);
         }
 
         long_size_t truncate(long_size_t size, error_code_ptr err = {})
         {
-            offset_tracker tracker{this};
+            if constexpr (positional_reader<Device> || positional_writer<Device>)
+            {
+                return io::truncate(m_device, size, err);
+            }
+            else
+            {
+                offset_tracker tracker{this};
 
-            return truncate(m_device, size, err);
+                return io::truncate(m_device, size, err);
+            }
         }
     };
 
@@ -115,26 +176,25 @@ namespace io
         {
         }
 
-        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        long_size_t offset(error_code_ptr ec = {}) const
         {
-            clear_error(ec);
-            auto off = offset(m_device, ec);
+            auto off = io::offset(m_device, ec);
             return off < m_shift ? 0 : (off - m_shift);
         }
 
-        bool is_eof(error_code_ptr ec = {}) const noexcept
+        bool is_eof(error_code_ptr ec = {}) const
         {
-            return is_eof(m_device, ec);
+            return io::is_eof(m_device, ec);
         }
 
         long_size_t seek(long_size_t offset, error_code_ptr ec = {})
         {
-            return seek(m_device, offset + m_shift, ec) - m_shift;
+            return io::seek(m_device, offset + m_shift, ec) - m_shift;
         }
 
-        long_size_t size(error_code_ptr ec = {}) const noexcept
+        long_size_t size(error_code_ptr ec = {}) const
         {
-            auto s = size(m_device, ec);
+            auto s = io::size(m_device, ec);
             return s < m_shift ? 0 : (s - m_shift);
         }
 
@@ -153,37 +213,39 @@ namespace io
 
         mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
         {
-            if (offset(m_device, ec) < m_shift)
-                seek_forward(m_device, m_shift, ec);
-            return read(m_device, buf, ec);
+            if (io::offset(m_device, ec) < m_shift)
+                io::seek_forward(m_device, m_shift, ec);
+            return io::read(m_device, buf, ec);
         }
 
         auto view_rd(long_offset_range h, error_code_ptr ec = {})
         {
-            return view_rd(m_device, {h.begin + m_shift, h.end + m_shift}, ec);
+            auto shift = long_offset_t(m_shift);
+            return io::view_rd(m_device, {h.begin + shift, h.end == unknown_offset ? h.end : h.end + shift}, ec);
         }
 
         const_buffer write(const_buffer buf, error_code_ptr ec = {})
         {
-            if (offset(m_device, ec) < m_shift)
-                seek_forward(m_device, m_shift, ec);
-            return write(m_device, buf, ec);
+            if (io::offset(m_device, ec) < m_shift)
+                io::seek_forward(m_device, m_shift, ec);
+            return io::write(m_device, buf, ec);
         }
 
         auto view_wr(long_offset_range h, error_code_ptr ec = {})
         {
-            long_offset_range shift_h{h.begin + m_shift, h.end + m_shift};
-            return view_wr(m_device, shift_h, ec);
+            auto shift = long_offset_t(m_shift);
+            long_offset_range shift_h{h.begin + shift, h.end == unknown_offset ? h.end : h.end + shift};
+            return io::view_wr(m_device, shift_h, ec);
         }
 
         void sync(error_code_ptr err = {})
         {
-            sync(m_device, err);
+            io::sync(m_device, err);
         }
 
         long_size_t truncate(long_size_t size, error_code_ptr err = {})
         {
-            return truncate(m_device, size + m_shift, err) - m_shift;
+            return io::truncate(m_device, size + m_shift, err) - m_shift;
         }
     };
 
@@ -199,28 +261,27 @@ namespace io
             APE_Expects(m_section.begin <= m_section.end);
         }
 
-        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        long_size_t offset(error_code_ptr ec = {}) const
         {
-            clear_error(ec);
-            auto off = std::clamp(offset(m_device, ec), m_section.begin, m_section.end);
-            return off - m_section.begin;;
+            auto off = std::clamp(long_offset_t(io::offset(m_device, ec)), m_section.begin, m_section.end);
+            return long_size_t(off - m_section.begin);
         }
 
-        bool is_eof(error_code_ptr ec = {}) const noexcept
+        bool is_eof(error_code_ptr ec = {}) const
         {
-            return offset(ec) == size(m_section);
+            return offset(ec) == ape::size(m_section);
         }
 
         long_size_t seek(long_size_t offset, error_code_ptr ec = {})
         {
-            return seek(m_device, offset + m_section.begin, ec) -
+            return io::seek(m_device, offset + m_section.begin, ec) -
                    m_section.begin;
         }
 
         long_size_t size(error_code_ptr ec = {}) const noexcept
         {
             clear_error(ec);
-            return size(m_section);
+            return ape::size(m_section);
         }
 
         Device& underlying() noexcept
@@ -239,135 +300,576 @@ namespace io
 
         mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
         {
-            auto off = offset(m_device, ec);
+            auto off = long_offset_t(io::offset(m_device, ec));
             if (off < m_section.begin)
-                seek_forward(m_device, m_section.begin, ec);
-            if (m_section.end < off)
+            {
+                io::seek_forward(m_device, m_section.begin, ec);
+                off = m_section.begin;
+            }
+            if (m_section.end <= off)
                 return buf.first(0);
 
-            auto avaliable_size = m_section.end - off;
-            auto buf_size = std::min(avaliable_size, buf.size());
-            return read(m_device, buf.first(buf_size), ec);
+            auto avaliable_size = long_size_t(m_section.end - off);
+            auto buf_size = std::size_t(std::min<long_size_t>(avaliable_size, buf.size()));
+            return io::read(m_device, buf.first(buf_size), ec);
         }
 
         auto view_rd(long_offset_range h, error_code_ptr ec = {})
         {
             auto first = h.begin + m_section.begin;
-            auto last = h.end + m_section.begin;
-            return view_rd(m_device, {first, std::min(last, m_section.end)}, ec);
+            auto last = h.end == unknown_offset ? m_section.end : h.end + m_section.begin;
+            return io::view_rd(m_device, {first, std::min(last, m_section.end)}, ec);
         }
 
         const_buffer write(const_buffer buf, error_code_ptr ec = {})
         {
-            auto off = offset(m_device, ec);
+            auto off = long_offset_t(io::offset(m_device, ec));
             if (off < m_section.begin)
-                seek_forward(m_device, m_section.begin, ec);
-            if (m_section.end < off)
+            {
+                io::seek_forward(m_device, m_section.begin, ec);
+                off = m_section.begin;
+            }
+            if (m_section.end <= off)
                 return buf;
 
-            auto avaliable_size = m_section.end - off;
-            auto buf_size = std::min(avaliable_size, buf.size());
-            auto res = write(m_device, buf.first(buf_size), ec);
+            auto avaliable_size = long_size_t(m_section.end - off);
+            auto buf_size = std::size_t(std::min<long_size_t>(avaliable_size, buf.size()));
+            auto res = io::write(m_device, buf.first(buf_size), ec);
             return {res.begin(), buf.end()};
         }
 
         auto view_wr(long_offset_range h, error_code_ptr ec = {})
         {
             auto first = h.begin + m_section.begin;
-            auto last = h.end + m_section.begin;
-            return view_wr(m_device, {first, std::min(last, m_section.end)}, ec);
+            auto last = h.end == unknown_offset ? m_section.end : h.end + m_section.begin;
+            return io::view_wr(m_device, {first, std::min(last, m_section.end)}, ec);
         }
 
         void sync(error_code_ptr err = {})
         {
-            sync(m_device, err);
+            io::sync(m_device, err);
         }
 
         long_size_t truncate(long_size_t size_, error_code_ptr err = {})
         {
-            if (size_ != size(m_section)){
+            if (size_ != ape::size(m_section)){
                 set_error_or_throw<io_exception>(err, std::errc::invalid_argument);
                 return {};
             }
             clear_error(err);
-            return size(m_section) ;
+            return ape::size(m_section) ;
         }
     };
 
-    struct cache_rd_view
+    namespace impl
     {
-        constexpr const_buffer address() const noexcept { return data; }
-        std::vector<std::byte> data;
+        struct pooled_buffer
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity{0};
+        };
+
+        // Free list of uninitialized byte buffers, shared by an adaptor and the views it returned.
+        // Views give their storage back on destruction, so a steady state allocates nothing.
+        class buffer_pool
+        {
+        public:
+            static constexpr std::size_t max_free = 16;
+
+            pooled_buffer acquire(std::size_t n)
+            {
+                {
+                    std::lock_guard lock(m_mutex);
+                    auto it = std::find_if(m_free.begin(), m_free.end(),
+                                           [n](const pooled_buffer &b) { return b.capacity >= n; });
+                    if (it != m_free.end())
+                    {
+                        auto res = std::move(*it);
+                        *it = std::move(m_free.back());
+                        m_free.pop_back();
+                        return res;
+                    }
+                }
+                return {std::make_unique_for_overwrite<std::byte[]>(n), n};
+            }
+
+            void release(pooled_buffer buf) noexcept
+            {
+                if (!buf.data)
+                    return;
+                std::lock_guard lock(m_mutex);
+                if (m_free.size() < max_free)
+                    m_free.push_back(std::move(buf));
+            }
+
+            std::size_t free_count() const
+            {
+                std::lock_guard lock(m_mutex);
+                return m_free.size();
+            }
+
+        private:
+            mutable std::mutex m_mutex;
+            std::vector<pooled_buffer> m_free;
+        };
+    }
+
+    class cache_rd_view
+    {
+    public:
+        cache_rd_view() noexcept = default;
+        cache_rd_view(std::shared_ptr<impl::buffer_pool> pool, impl::pooled_buffer buf, std::size_t size) noexcept
+            : m_pool(std::move(pool)), m_buffer(std::move(buf)), m_size(size) {}
+
+        cache_rd_view(cache_rd_view &&) noexcept = default;
+        cache_rd_view &operator=(cache_rd_view &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                recycle();
+                m_pool = std::move(rhs.m_pool);
+                m_buffer = std::move(rhs.m_buffer);
+                m_size = std::exchange(rhs.m_size, 0);
+            }
+            return *this;
+        }
+        ~cache_rd_view() { recycle(); }
+
+        const_buffer address() const noexcept { return {m_buffer.data.get(), m_size}; }
+
+    private:
+        void recycle() noexcept
+        {
+            if (m_pool)
+                m_pool->release(std::move(m_buffer));
+        }
+
+        std::shared_ptr<impl::buffer_pool> m_pool;
+        impl::pooled_buffer m_buffer;
+        std::size_t m_size{0};
     };
 
+    // Exposes a reader as read_map, each view is a copy of the range read from the device.
+    // View storage comes from a pool owned by the adaptor and is not zero filled.
     template<reader Device>
     class reader_to_view
     {
         Device &m_device;
+        std::shared_ptr<impl::buffer_pool> m_pool = std::make_shared<impl::buffer_pool>();
         public:
         explicit reader_to_view(Device& d) noexcept : m_device(d){}
 
+        long_size_t size(error_code_ptr err = {}) const requires sizer<Device>
+        {
+            return io::size(m_device, err);
+        }
+
         cache_rd_view view_rd(long_offset_range rng, error_code_ptr err = {}){
-            if (!in_size_t_range(size(rng)))
+            if (!in_size_t_range(ape::size(rng)))
             {
                 set_error_or_throw<io_exception>(err, std::errc::value_too_large);
                 return {};
             }
+            if constexpr (random<Device>)
+            {
+                if (io::supports(m_device, device_caps::random))
+                {
+                    io::seek(m_device, rng.begin, err);
+                    if (has_error(err))
+                        return {};
+                }
+            }
 
-            cache_rd_view res;
-            res.data.resize(size(rng));
-            res.data.resize(read(m_device, mutable_buffer(res.data), err).size());
-            return res;
+            auto n = narrow_cast(ape::size(rng));
+            auto buf = m_pool->acquire(n);
+            std::size_t done = 0;
+            while (done < n)
+            {
+                auto got = io::read(m_device, mutable_buffer(buf.data.get() + done, n - done), err).size();
+                if (got == 0 || has_error(err))
+                    break;
+                done += got;
+            }
+            return cache_rd_view(m_pool, std::move(buf), done);
         }
 
+        const impl::buffer_pool& pool() const noexcept { return *m_pool; }
     };
 
+    template<writer Device>
+    requires random<Device>
+    class writer_to_view;
+
+    // Writable copy of a range of a writer_to_view.
+    // Only dirty sub-ranges are written back, they are handed to the adaptor on release or destruction,
+    // which merges them with the other pending writes. address() conservatively marks the
+    // whole view dirty, modify() and mark_dirty() only the bytes actually patched.
     template<writer Device>
     requires random<Device>
     class cache_wr_view
     {
-        Device &m_device;
-        std::vector<std::byte> data;
-        long_offset_t pos;
+        using owner_type = writer_to_view<Device>;
     public:
-        cache_wr_view(Device&d, std::vector<std::byte> data, long_offset_t p)
-            : m_device(d)
-            , data(std::move(data))
-            , pos(p)
+        cache_wr_view() noexcept = default;
+        cache_wr_view(owner_type* owner, impl::pooled_buffer buf, std::size_t size, long_size_t p) noexcept
+            : m_owner(owner)
+            , m_buffer(std::move(buf))
+            , m_size(size)
+            , m_pos(p)
+        {
+        }
+
+        cache_wr_view(cache_wr_view&& rhs) noexcept
+            : m_owner(std::exchange(rhs.m_owner, nullptr))
+            , m_buffer(std::move(rhs.m_buffer))
+            , m_size(std::exchange(rhs.m_size, 0))
+            , m_pos(rhs.m_pos)
+            , m_dirty(std::move(rhs.m_dirty))
+        {
+        }
+        cache_wr_view& operator=(cache_wr_view&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                release_or_defer();
+                m_owner = std::exchange(rhs.m_owner, nullptr);
+                m_buffer = std::move(rhs.m_buffer);
+                m_size = std::exchange(rhs.m_size, 0);
+                m_pos = rhs.m_pos;
+                m_dirty = std::move(rhs.m_dirty);
+            }
+            return *this;
+        }
+        ~cache_wr_view() { release_or_defer(); }
+
+        mutable_buffer address() noexcept
+        {
+            mark_dirty(0, m_size);
+            return {m_buffer.data.get(), m_size};
+        }
+
+        // read only access, marks nothing dirty
+        const_buffer data() const noexcept { return {m_buffer.data.get(), m_size}; }
+
+        mutable_buffer modify(std::size_t first, std::size_t n) noexcept
         {
+            APE_Expects(first <= m_size && n <= m_size - first);
+            mark_dirty(first, first + n);
+            return {m_buffer.data.get() + first, n};
         }
 
-        constexpr mutable_buffer address() noexcept
+        // mark [first, last) of the view dirty, overlapping and adjacent dirty ranges are merged
+        void mark_dirty(std::size_t first, std::size_t last) noexcept
         {
-            return data;
+            APE_Expects(first <= last && last <= m_size);
+            if (first == last)
+                return;
+            auto it = std::lower_bound(m_dirty.begin(), m_dirty.end(), first,
+                                       [](const auto& r, std::size_t v) { return r.second < v; });
+            auto stop = it;
+            while (stop != m_dirty.end() && stop->first <= last)
+            {
+                first = std::min(first, stop->first);
+                last = std::max(last, stop->second);
+                ++stop;
+            }
+            it = m_dirty.erase(it, stop);
+            m_dirty.insert(it, {first, last});
         }
-        ~cache_wr_view() {
-            seek(m_device, pos);
-            write(m_device, data);
+
+        std::size_t dirty_bytes() const noexcept
+        {
+            std::size_t n = 0;
+            for (auto& r : m_dirty)
+                n += r.second - r.first;
+            return n;
         }
+
+        // hand the dirty ranges to the adaptor and detach, not_enough_memory when they cannot be
+        // staged. Destruction and assignment release too, their failures are reported by flush().
+        void release(error_code_ptr err = {});
+
+    private:
+        void release_or_defer() noexcept;
+
+        owner_type* m_owner = nullptr;
+        impl::pooled_buffer m_buffer;
+        std::size_t m_size{0};
+        long_size_t m_pos{0};
+        std::vector<std::pair<std::size_t, std::size_t>> m_dirty; // sorted, disjoint [first, last)
     };
 
+    // Exposes a random writer as write_map.
+    // Views are filled from the device when it is readable, their dirty ranges are staged in the
+    // adaptor and merged with adjacent or overlapping pending writes, then written back in one
+    // write per merged range by sync(), by the destructor, or when pending bytes exceed the limit.
+    // Views must not outlive the adaptor.
     template<writer Device>
+    requires random<Device>
     class writer_to_view
     {
+        friend class cache_wr_view<Device>;
+
         Device &m_device;
+        std::shared_ptr<impl::buffer_pool> m_pool = std::make_shared<impl::buffer_pool>();
+        std::map<long_size_t, std::vector<std::byte>> m_pending; // disjoint, non adjacent
+        std::size_t m_pending_bytes = 0;
+        std::size_t m_pending_limit;
+        error_code m_deferred_error;
         public:
-        explicit writer_to_view(Device& d) noexcept : m_device(d){}
+        static constexpr std::size_t default_pending_limit = 1024 * 1024;
+
+        explicit writer_to_view(Device& d, std::size_t pending_limit = default_pending_limit) noexcept
+            : m_device(d), m_pending_limit(pending_limit){}
+
+        writer_to_view(const writer_to_view&) = delete;
+        writer_to_view& operator=(const writer_to_view&) = delete;
 
-        cache_rd_view view_wr(long_offset_range rng, error_code_ptr err = {}){
-            if (!in_size_t_range(size(rng)))
+        ~writer_to_view()
+        {
+            error_code ec;
+            flush(error_code_ptr(&ec));
+        }
+
+        long_size_t size(error_code_ptr err = {}) const requires sizer<Device>
+        {
+            auto s = io::size(m_device, err);
+            if (!m_pending.empty())
+            {
+                auto& last = *m_pending.rbegin();
+                s = std::max<long_size_t>(s, last.first + last.second.size());
+            }
+            return s;
+        }
+
+        std::size_t pending_bytes() const noexcept { return m_pending_bytes; }
+        std::size_t pending_writes() const noexcept { return m_pending.size(); }
+
+        cache_wr_view<Device> view_wr(long_offset_range rng, error_code_ptr err = {}){
+            if (!in_size_t_range(ape::size(rng)))
             {
                 set_error_or_throw<io_exception>(err, std::errc::value_too_large);
                 return {};
             }
 
-            cache_wr_view res(m_device, {}, rng.begin);
-            res.data.resize(size(rng));
-            return res;
+            auto n = narrow_cast(ape::size(rng));
+            auto buf = m_pool->acquire(n);
+            fill(long_size_t(rng.begin), {buf.data.get(), n}, err);
+            if (has_error(err))
+            {
+                m_pool->release(std::move(buf));
+                return {};
+            }
+            return cache_wr_view<Device>(this, std::move(buf), n, long_size_t(rng.begin));
+        }
+
+        // write back all pending ranges, reports errors of write backs triggered by views too
+        void flush(error_code_ptr err = {})
+        {
+            for (auto it = m_pending.begin(); it != m_pending.end(); it = m_pending.erase(it))
+            {
+                if (!write_back(it->first, it->second, err))
+                    return;
+                m_pending_bytes -= it->second.size();
+            }
+            if (m_deferred_error)
+            {
+                set_error_or_throw<io_exception>(err, std::exchange(m_deferred_error, {}));
+                return;
+            }
+            clear_error(err);
+        }
+
+        void sync(error_code_ptr err = {})
+        {
+            flush(err);
+            if (has_error(err))
+                return;
+            if constexpr (syncer<Device>)
+                io::sync(m_device, err);
+        }
+
+    private:
+        // bytes of the device read into buf from off, none when the device cannot be read
+        std::size_t read_back(long_size_t off, mutable_buffer buf, error_code_ptr err)
+        {
+            std::size_t done = 0;
+            if constexpr (positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_reader))
+                {
+                    while (done < buf.size())
+                    {
+                        auto got = io::read_at(m_device, off + done, buf.subspan(done), err).size();
+                        if (got == 0 || has_error(err))
+                            break;
+                        done += got;
+                    }
+                    return done;
+                }
+            }
+            if constexpr (reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::reader))
+                {
+                    io::seek(m_device, off, err);
+                    while (done < buf.size() && !has_error(err))
+                    {
+                        auto got = io::read(m_device, buf.subspan(done), err).size();
+                        if (got == 0)
+                            break;
+                        done += got;
+                    }
+                    return done;
+                }
+            }
+            clear_error(err); // nothing to read back, the view starts zeroed
+            return done;
         }
 
+        void fill(long_size_t off, mutable_buffer buf, error_code_ptr err)
+        {
+            auto done = read_back(off, buf, err);
+            if (has_error(err))
+                return;
+            std::memset(buf.data() + done, 0, buf.size() - done);
+
+            // pending writes are newer than the device content
+            auto it = m_pending.upper_bound(off);
+            if (it != m_pending.begin())
+                --it;
+            for (; it != m_pending.end() && it->first < off + buf.size(); ++it)
+            {
+                auto first = std::max(it->first, off);
+                auto last = std::min(it->first + it->second.size(), off + buf.size());
+                if (first < last)
+                    std::memcpy(buf.data() + (first - off), it->second.data() + (first - it->first), last - first);
+            }
+        }
+
+        // merge data into the pending writes, on failure they are left as they were
+        void stage(long_size_t off, const_buffer data, error_code_ptr err)
+        {
+            auto first = off;
+            auto last = off + data.size();
+
+            auto it = m_pending.upper_bound(off);
+            if (it != m_pending.begin() && std::prev(it)->first + std::prev(it)->second.size() >= off)
+                --it;
+            auto stop = it;
+            while (stop != m_pending.end() && stop->first <= last)
+            {
+                first = std::min(first, stop->first);
+                last = std::max<long_size_t>(last, stop->first + stop->second.size());
+                ++stop;
+            }
+
+            try
+            {
+                std::vector<std::byte> merged(narrow_cast(last - first));
+                for (auto i = it; i != stop; ++i)
+                    std::memcpy(merged.data() + (i->first - first), i->second.data(), i->second.size());
+                std::memcpy(merged.data() + (off - first), data.data(), data.size());
+
+                if (it == stop)
+                    m_pending.emplace_hint(stop, first, std::move(merged));
+                else
+                { // reuse a merged node, nothing left to allocate
+                    for (auto i = it; i != stop; ++i)
+                        m_pending_bytes -= i->second.size();
+                    auto node = m_pending.extract(it++);
+                    m_pending.erase(it, stop);
+                    node.key() = first;
+                    node.mapped() = std::move(merged);
+                    m_pending.insert(stop, std::move(node));
+                }
+                m_pending_bytes += last - first;
+            }
+            catch (const std::bad_alloc &)
+            {
+                set_error_or_throw<io_exception>(err, std::errc::not_enough_memory);
+                return;
+            }
+            clear_error(err);
+
+            if (m_pending_bytes > m_pending_limit)
+            {
+                error_code ec;
+                flush(error_code_ptr(&ec));
+                if (ec)
+                    m_deferred_error = ec;
+            }
+        }
+
+        // write all of data at off, io_error when a write makes no progress
+        bool write_back(long_size_t off, const_buffer data, error_code_ptr err)
+        {
+            bool positional = false;
+            if constexpr (positional_writer<Device>)
+                positional = io::supports(m_device, device_caps::positional_writer);
+            if (!positional)
+            {
+                io::seek(m_device, off, err);
+                if (has_error(err))
+                    return false;
+            }
+            while (!data.empty())
+            {
+                const_buffer rest;
+                if constexpr (positional_writer<Device>)
+                    rest = positional ? io::write_at(m_device, off, data, err) : io::write(m_device, data, err);
+                else
+                    rest = io::write(m_device, data, err);
+                if (has_error(err))
+                    return false;
+                if (rest.size() == data.size())
+                {
+                    set_error_or_throw<io_exception>(err, std::errc::io_error);
+                    return false;
+                }
+                off += data.size() - rest.size();
+                data = rest;
+            }
+            clear_error(err);
+            return true;
+        }
     };
 
+    template<writer Device>
+    requires random<Device>
+    void cache_wr_view<Device>::release(error_code_ptr err)
+    {
+        if (!m_owner)
+        {
+            clear_error(err);
+            return;
+        }
+        auto owner = std::exchange(m_owner, nullptr);
+        error_code ec;
+        for (auto& r : m_dirty)
+        {
+            owner->stage(m_pos + r.first, {m_buffer.data.get() + r.first, r.second - r.first}, error_code_ptr(&ec));
+            if (ec)
+                break;
+        }
+        m_dirty.clear();
+        owner->m_pool->release(std::move(m_buffer));
+        if (ec)
+            set_error_or_throw<io_exception>(err, ec);
+        else
+            clear_error(err);
+    }
+
+    template<writer Device>
+    requires random<Device>
+    void cache_wr_view<Device>::release_or_defer() noexcept
+    {
+        auto owner = m_owner;
+        error_code ec;
+        release(error_code_ptr(&ec));
+        if (ec)
+            owner->m_deferred_error = ec;
+    }
 
 }
 
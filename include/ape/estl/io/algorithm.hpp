@@ -0,0 +1,509 @@
+#pragma once
+#ifndef APE_ESTL_IO_ALGORITHM_H
+#define APE_ESTL_IO_ALGORITHM_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    // Device backed by a posix file descriptor, which the kernel may write to directly.
+    // Devices opt in with a native_file_tag member type when they keep nothing of the file in user
+    // space but an offset; mapped_file_device does not, its size and mapping would go stale.
+    template <typename Device>
+    concept native_file = requires(const Device &device) {
+        typename Device::native_file_tag;
+        {
+            device.native_handle()
+        } -> std::same_as<int>;
+    };
+
+    namespace impl
+    {
+        inline constexpr std::size_t copy_buffer_size = 256 * 1024;
+        inline constexpr std::size_t copy_buffer_alignment = 4096;
+
+        // per thread bounce buffer of io::copy, page aligned so it also suits unbuffered devices
+        inline mutable_buffer copy_bounce_buffer()
+        {
+            struct aligned_delete
+            {
+                void operator()(std::byte *p) const noexcept
+                {
+                    ::operator delete(p, std::align_val_t(copy_buffer_alignment));
+                }
+            };
+            thread_local std::unique_ptr<std::byte, aligned_delete> buffer(
+                static_cast<std::byte *>(::operator new(copy_buffer_size, std::align_val_t(copy_buffer_alignment))));
+            return {buffer.get(), copy_buffer_size};
+        }
+
+        template <typename Src, typename Dst>
+        long_size_t copy_views(Src &src, Dst &dst, long_offset_range rng, long_size_t dst_off, error_code_ptr ec)
+        {
+            auto n = ape::size(rng);
+            if (!in_size_t_range(n))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return 0;
+            }
+            // dst first: growing it may move the storage, a src view of the same device taken before
+            // would dangle
+            auto wv = io::view_wr(dst, {long_offset_t(dst_off), long_offset_t(dst_off + n)}, ec);
+            if (has_error(ec))
+                return 0;
+            auto rv = io::view_rd(src, rng, ec);
+            if (has_error(ec))
+                return 0;
+
+            const_buffer from = io::address(rv);
+            mutable_buffer to = io::address(wv);
+            auto len = std::min(from.size(), to.size());
+            if (len != 0)
+                std::memmove(to.data(), from.data(), len); // src and dst may view the same storage
+            io::seek(dst, dst_off + len, ec);
+            return len;
+        }
+
+#if defined(__linux__)
+        // copy_file_range, or sendfile where the kernel refuses it (e.g. across file systems).
+        // n == unknown_size copies to the end of in. Sets fallback when nothing could be copied
+        // in kernel, the caller then copies through user space.
+        inline long_size_t copy_fds(int in, long_size_t in_off, int out, long_size_t out_off, long_size_t n,
+                                    bool &fallback, error_code_ptr ec)
+        {
+            constexpr std::size_t max_chunk = std::size_t(1) << 30;
+            bool use_copy_file_range = true;
+            long_size_t done = 0;
+            fallback = false;
+            while (n == unknown_size || done < n)
+            {
+                auto chunk = std::size_t(std::min<long_size_t>(n - done, max_chunk));
+                ssize_t r;
+                if (use_copy_file_range)
+                {
+                    loff_t src_pos = loff_t(in_off + done), dst_pos = loff_t(out_off + done);
+                    r = ::copy_file_range(in, &src_pos, out, &dst_pos, chunk, 0);
+                }
+                else
+                {
+                    // sendfile writes at the file offset of out, devices here use positional io
+                    // so moving it is harmless
+                    off_t src_pos = off_t(in_off + done);
+                    r = ::lseek(out, off_t(out_off + done), SEEK_SET) < 0 ? -1 : ::sendfile(out, in, &src_pos, chunk);
+                }
+
+                if (r < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    if (use_copy_file_range &&
+                        (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+                    {
+                        use_copy_file_range = false;
+                        continue;
+                    }
+                    if (done == 0 && (errno == EINVAL || errno == ENOSYS))
+                    {
+                        fallback = true;
+                        clear_error(ec);
+                        return 0;
+                    }
+                    set_error_or_throw<io_exception>(ec, error_code(errno, std::system_category()));
+                    return done;
+                }
+                if (r == 0)
+                    break;
+                done += long_size_t(r);
+            }
+            clear_error(ec);
+            return done;
+        }
+#endif
+
+        template <typename Dst>
+        bool write_all(Dst &dst, const_buffer buf, error_code_ptr ec)
+        {
+            while (!buf.empty())
+            {
+                auto rest = io::write(dst, buf, ec);
+                if (has_error(ec))
+                    return false;
+                if (rest.size() == buf.size())
+                {
+                    set_error_or_throw<io_exception>(ec, std::errc::io_error);
+                    return false;
+                }
+                buf = rest;
+            }
+            return true;
+        }
+
+        template <typename Src, typename Dst>
+        long_size_t copy_loop(Src &src, Dst &dst, long_offset_range rng, mutable_buffer bounce, error_code_ptr ec)
+        {
+            APE_Expects(!bounce.empty());
+            bool positional = false;
+            if constexpr (positional_reader<Src>)
+                positional = io::supports(src, device_caps::positional_reader);
+            if constexpr (random<Src>)
+            {
+                if (!positional && io::supports(src, device_caps::random))
+                {
+                    io::seek(src, long_size_t(rng.begin), ec);
+                    if (has_error(ec))
+                        return 0;
+                }
+            }
+
+            long_size_t done = 0;
+            for (;;)
+            {
+                auto chunk = bounce;
+                if (rng.end != unknown_offset)
+                {
+                    auto rest = ape::size(rng) - done;
+                    if (rest == 0)
+                        break;
+                    chunk = bounce.first(std::size_t(std::min<long_size_t>(rest, bounce.size())));
+                }
+
+                mutable_buffer got;
+                if constexpr (positional_reader<Src>)
+                    got = positional ? io::read_at(src, long_size_t(rng.begin) + done, chunk, ec) : io::read(src, chunk, ec);
+                else
+                    got = io::read(src, chunk, ec);
+                if (has_error(ec) || got.empty())
+                    break;
+                if (!write_all(dst, got, ec))
+                    break;
+                done += got.size();
+            }
+            if (!has_error(ec))
+                clear_error(ec);
+            return done;
+        }
+    }
+
+    // Copy bytes [rng.begin, rng.end) of src to dst at its current offset, stopping at the end of src,
+    // rng.end may be unknown_offset to copy all of it. Returns the number of bytes copied, dst offset advances by it.
+    // Device views are used when src is read_map and dst write_map, copy_file_range/sendfile when
+    // both are files, otherwise (also where io::supports denies the concepts of either device) the data goes through bounce in chunks. A src without positional io
+    // is left at an unspecified offset, one which is not random is read from its current offset.
+    template <reader Src, writer Dst>
+    long_size_t copy(Src &src, Dst &dst, long_offset_range rng, mutable_buffer bounce, error_code_ptr ec = {})
+    {
+        APE_Expects(is_valid_range(rng));
+
+        long_size_t dst_off = 0;
+        if constexpr (sequence<Dst>)
+        {
+            if (io::supports(dst, device_caps::sequence))
+            {
+                dst_off = io::offset(dst, ec);
+                if (has_error(ec))
+                    return 0;
+            }
+        }
+
+        if constexpr (read_map<Src> && write_map<Dst> && random<Dst>)
+        {
+            if (io::supports(src, device_caps::read_map) &&
+                io::supports(dst, device_caps::write_map | device_caps::random))
+            {
+                // stop at the end of src as the other paths do
+                auto s = io::size(src, ec);
+                if (has_error(ec))
+                    return 0;
+                rng.end = std::max(rng.begin, std::min(rng.end, long_offset_t(s)));
+                return impl::copy_views(src, dst, rng, dst_off, ec);
+            }
+        }
+#if defined(__linux__)
+        if constexpr (native_file<Src> && native_file<Dst> && random<Dst>)
+        {
+            bool fallback = false;
+            auto n = rng.end == unknown_offset ? unknown_size : ape::size(rng);
+            auto done = impl::copy_fds(src.native_handle(), long_size_t(rng.begin), dst.native_handle(), dst_off, n,
+                                       fallback, ec);
+            if (!fallback)
+            {
+                if (done != 0)
+                {
+                    error_code seek_ec;
+                    io::seek(dst, dst_off + done, error_code_ptr(&seek_ec));
+                    if (!has_error(ec) && seek_ec)
+                        set_error_or_throw<io_exception>(ec, seek_ec);
+                }
+                return done;
+            }
+        }
+#endif
+        return impl::copy_loop(src, dst, rng, bounce, ec);
+    }
+
+    // io::copy with the per thread bounce buffer
+    template <reader Src, writer Dst>
+    long_size_t copy(Src &src, Dst &dst, long_offset_range rng, error_code_ptr ec = {})
+    {
+        return io::copy(src, dst, rng, impl::copy_bounce_buffer(), ec);
+    }
+
+    namespace impl
+    {
+        inline bool is_zero(const_buffer buf) noexcept
+        {
+            return std::all_of(buf.begin(), buf.end(), [](std::byte b) { return b == std::byte{0}; });
+        }
+
+        // copy [begin, end) of src to the same offsets of dst, returns the bytes written. Files go whole
+        // through copy_file_range, elsewhere chunks reading as zeros are neither written nor counted.
+        template <typename Src, typename Dst>
+        long_size_t copy_extent(Src &src, Dst &dst, long_size_t begin, long_size_t end, mutable_buffer bounce,
+                                error_code_ptr ec)
+        {
+#if defined(__linux__)
+            if constexpr (native_file<Src> && native_file<Dst>)
+            {
+                bool fallback = false;
+                auto done = copy_fds(src.native_handle(), begin, dst.native_handle(), begin, end - begin, fallback, ec);
+                if (!fallback)
+                    return done;
+            }
+#endif
+            long_size_t written = 0;
+            for (auto pos = begin; pos < end;)
+            {
+                auto chunk = bounce.first(std::size_t(std::min<long_size_t>(end - pos, bounce.size())));
+                auto got = io::read_at(src, pos, chunk, ec);
+                if (has_error(ec) || got.empty())
+                    break;
+                if (!is_zero(got))
+                {
+                    auto rest = io::write_at(dst, pos, got, ec);
+                    if (has_error(ec))
+                        break;
+                    if (!rest.empty())
+                    {
+                        set_error_or_throw<io_exception>(ec, std::errc::io_error);
+                        break;
+                    }
+                    written += got.size();
+                }
+                pos += got.size();
+            }
+            return written;
+        }
+    }
+
+    // Make dst a copy of src reading and writing only the data extents of src (extent_finder).
+    // dst is truncated to nothing and regrown to size(src), so it starts as a single hole and the
+    // holes of src stay holes. Time and space follow the data of src, not its size. Files on Linux
+    // copy each data extent whole with copy_file_range, zeros included, which lets the file system
+    // share blocks. Other devices go through bounce and leave chunks of data extents reading as zeros
+    // unwritten. Returns the bytes written to dst, zero chunks skipped through bounce not counted.
+    template <positional_reader Src, positional_writer Dst>
+        requires extent_finder<Src> && truncater<Dst>
+    long_size_t sparse_copy(Src &src, Dst &dst, mutable_buffer bounce, error_code_ptr ec = {})
+    {
+        APE_Expects(!bounce.empty());
+        auto size = io::size(src, ec);
+        if (has_error(ec))
+            return 0;
+        io::truncate(dst, 0, ec);
+        if (!has_error(ec))
+            io::truncate(dst, size, ec);
+        if (has_error(ec))
+            return 0;
+
+        long_size_t written = 0;
+        for (auto pos = io::find_data(src, 0, ec); !has_error(ec) && pos < size;)
+        {
+            auto hole = std::min(io::find_hole(src, pos, ec), size);
+            if (has_error(ec))
+                break;
+            written += impl::copy_extent(src, dst, pos, hole, bounce, ec);
+            if (has_error(ec))
+                break;
+            pos = io::find_data(src, hole, ec);
+        }
+        return written;
+    }
+
+    // io::sparse_copy with the per thread bounce buffer
+    template <positional_reader Src, positional_writer Dst>
+        requires extent_finder<Src> && truncater<Dst>
+    long_size_t sparse_copy(Src &src, Dst &dst, error_code_ptr ec = {})
+    {
+        return io::sparse_copy(src, dst, impl::copy_bounce_buffer(), ec);
+    }
+
+    namespace impl
+    {
+        // fill buf from off, short only at the end of device or on error
+        template <typename Device>
+        std::size_t read_full_at(Device &dev, long_size_t off, mutable_buffer buf, error_code_ptr ec)
+        {
+            std::size_t n = 0;
+            bool positional = false;
+            if constexpr (positional_reader<Device>)
+                positional = io::supports(dev, device_caps::positional_reader);
+            if constexpr (random<Device>)
+            {
+                if (!positional)
+                {
+                    io::seek(dev, off, ec);
+                    if (has_error(ec))
+                        return 0;
+                }
+            }
+            while (n < buf.size())
+            {
+                mutable_buffer got;
+                if constexpr (positional_reader<Device>)
+                    got = positional ? io::read_at(dev, off + n, buf.subspan(n), ec) : io::read(dev, buf.subspan(n), ec);
+                else
+                    got = io::read(dev, buf.subspan(n), ec);
+                if (has_error(ec) || got.empty())
+                    break;
+                n += got.size();
+            }
+            return n;
+        }
+
+        // read_ranges over a read_map device, each range copied out of a view
+        template <typename Device>
+        long_size_t read_ranges_views(Device &dev, std::span<const long_offset_range> ranges,
+                                      std::span<mutable_buffer> bufs, error_code_ptr ec)
+        {
+            long_size_t total = 0;
+            auto dev_size = io::size(dev, ec);
+            if (has_error(ec))
+                return 0;
+            for (std::size_t i = 0; i < ranges.size(); ++i)
+            {
+                auto begin = std::min<long_size_t>(long_size_t(ranges[i].begin), dev_size);
+                auto end = std::min<long_size_t>(begin + bufs[i].size(), dev_size);
+                auto v = io::view_rd(dev, {long_offset_t(begin), long_offset_t(end)}, ec);
+                if (has_error(ec))
+                {
+                    for (auto j = i; j < bufs.size(); ++j)
+                        bufs[j] = bufs[j].first(0);
+                    return total;
+                }
+                const_buffer from = io::address(v);
+                auto n = std::min(from.size(), bufs[i].size());
+                if (n != 0)
+                    std::memcpy(bufs[i].data(), from.data(), n);
+                bufs[i] = bufs[i].first(n);
+                total += n;
+            }
+            return total;
+        }
+    }
+
+    // Read ranges[i] into bufs[i] for every i, each buffer is then cut to the bytes read: less than the
+    // range at the end of device, nothing for ranges not reached because of an error. Returns the total.
+    // On devices supporting read_map each range is a copy out of a view. Otherwise ranges are sorted and those
+    // less than max_gap apart are read by one device operation through bounce, then scattered;
+    // ranges merged beyond bounce.size() are read separately, straight into their buffer.
+    // read_at is used where available, seek+read otherwise.
+    template <reader Device>
+        requires read_map<Device> || positional_reader<Device> || random<Device>
+    long_size_t read_ranges(Device &dev, std::span<const long_offset_range> ranges, std::span<mutable_buffer> bufs,
+                            long_size_t max_gap, mutable_buffer bounce, error_code_ptr ec = {})
+    {
+        APE_Expects(ranges.size() == bufs.size());
+        for (std::size_t i = 0; i < ranges.size(); ++i)
+        {
+            APE_Expects(is_valid_range(ranges[i]) && ranges[i].end != unknown_offset);
+            bufs[i] = bufs[i].first(std::size_t(std::min<long_size_t>(bufs[i].size(), ape::size(ranges[i]))));
+        }
+        clear_error(ec);
+        long_size_t total = 0;
+
+        if constexpr (read_map<Device>)
+        {
+            if (io::supports(dev, device_caps::read_map))
+                return impl::read_ranges_views(dev, ranges, bufs, ec);
+        }
+        if constexpr (positional_reader<Device> || random<Device>)
+        {
+            std::vector<std::size_t> order(ranges.size());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::sort(order.begin(), order.end(),
+                      [&](std::size_t a, std::size_t b) { return ranges[a].begin < ranges[b].begin; });
+
+            auto end_of = [&](std::size_t i) { return long_size_t(ranges[i].begin) + bufs[i].size(); };
+            for (std::size_t first = 0; first < order.size();)
+            {
+                // grow the group while the next range starts within max_gap and the span fits bounce
+                auto begin = long_size_t(ranges[order[first]].begin);
+                auto end = end_of(order[first]);
+                auto last = first + 1;
+                for (; last < order.size(); ++last)
+                {
+                    auto next_begin = long_size_t(ranges[order[last]].begin);
+                    auto next_end = std::max(end, end_of(order[last]));
+                    if (next_begin > end && next_begin - end > max_gap)
+                        break;
+                    if (next_end - begin > bounce.size())
+                        break;
+                    end = next_end;
+                }
+
+                if (last == first + 1)
+                {
+                    auto &buf = bufs[order[first]];
+                    buf = buf.first(impl::read_full_at(dev, begin, buf, ec));
+                    total += buf.size();
+                }
+                else
+                {
+                    auto got = impl::read_full_at(dev, begin, bounce.first(std::size_t(end - begin)), ec);
+                    for (auto k = first; k < last; ++k)
+                    {
+                        auto &buf = bufs[order[k]];
+                        auto off = std::size_t(long_size_t(ranges[order[k]].begin) - begin);
+                        auto n = off < got ? std::min(buf.size(), got - off) : 0;
+                        if (n != 0)
+                            std::memcpy(buf.data(), bounce.data() + off, n);
+                        buf = buf.first(n);
+                        total += n;
+                    }
+                }
+                if (has_error(ec))
+                {
+                    for (auto k = last; k < order.size(); ++k)
+                        bufs[order[k]] = bufs[order[k]].first(0);
+                    return total;
+                }
+                first = last;
+            }
+        }
+        return total;
+    }
+
+    // io::read_ranges merging ranges closer than the device block size, with the per thread bounce buffer
+    template <reader Device>
+        requires read_map<Device> || positional_reader<Device> || random<Device>
+    long_size_t read_ranges(Device &dev, std::span<const long_offset_range> ranges, std::span<mutable_buffer> bufs,
+                            error_code_ptr ec = {})
+    {
+        return io::read_ranges(dev, ranges, bufs, get_option<block_size_option>(dev), impl::copy_bounce_buffer(), ec);
+    }
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_ALGORITHM_H
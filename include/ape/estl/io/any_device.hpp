@@ -0,0 +1,539 @@
+#pragma once
+#ifndef APE_ESTL_IO_ANY_DEVICE_H
+#define APE_ESTL_IO_ANY_DEVICE_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    namespace impl
+    {
+        // Raw storage holding an object inline when it fits and moves without throwing,
+        // otherwise a pointer to it on the heap. The owner knows the stored type.
+        template <std::size_t Size>
+        struct small_storage
+        {
+            template <typename T>
+            static constexpr bool is_inline = sizeof(T) <= Size && alignof(T) <= alignof(std::max_align_t) &&
+                                              std::is_nothrow_move_constructible_v<T>;
+
+            template <typename T, typename... Args>
+            void emplace(Args &&...args)
+            {
+                if constexpr (is_inline<T>)
+                    ::new (static_cast<void *>(bytes)) T(std::forward<Args>(args)...);
+                else
+                    ::new (static_cast<void *>(bytes)) T *(new T(std::forward<Args>(args)...));
+            }
+
+            template <typename T>
+            T *get() noexcept
+            {
+                if constexpr (is_inline<T>)
+                    return std::launder(reinterpret_cast<T *>(bytes));
+                else
+                    return *std::launder(reinterpret_cast<T **>(bytes));
+            }
+
+            template <typename T>
+            static void destroy(small_storage &s) noexcept
+            {
+                if constexpr (is_inline<T>)
+                    s.get<T>()->~T();
+                else
+                    delete s.get<T>();
+            }
+
+            // move the object of src into the empty dst, leaving src empty
+            template <typename T>
+            static void relocate(small_storage &dst, small_storage &src) noexcept
+            {
+                if constexpr (is_inline<T>)
+                {
+                    ::new (static_cast<void *>(dst.bytes)) T(std::move(*src.get<T>()));
+                    src.get<T>()->~T();
+                }
+                else
+                    ::new (static_cast<void *>(dst.bytes)) T *(src.get<T>());
+            }
+
+            alignas(std::max_align_t) std::byte bytes[Size];
+        };
+
+        using view_storage = small_storage<6 * sizeof(void *)>;
+
+        struct view_vtable
+        {
+            void (*destroy)(view_storage &) noexcept;
+            void (*relocate)(view_storage &, view_storage &) noexcept;
+        };
+
+        template <typename View>
+        inline constexpr view_vtable view_vtable_for = {&view_storage::destroy<View>, &view_storage::relocate<View>};
+
+        // keeps a device view alive, along with the buffer it exposes
+        template <typename Buffer>
+        class any_view
+        {
+        public:
+            any_view() noexcept = default;
+
+            template <typename View>
+                requires(!std::is_same_v<std::remove_cvref_t<View>, any_view>)
+            explicit any_view(View &&v)
+            {
+                using view_type = std::remove_cvref_t<View>;
+                m_storage.emplace<view_type>(std::forward<View>(v));
+                m_vt = &view_vtable_for<view_type>;
+                m_data = io::address(*m_storage.get<view_type>());
+            }
+
+            any_view(any_view &&rhs) noexcept : m_vt(std::exchange(rhs.m_vt, nullptr)), m_data(rhs.m_data)
+            {
+                if (m_vt)
+                    m_vt->relocate(m_storage, rhs.m_storage);
+            }
+            any_view &operator=(any_view &&rhs) noexcept
+            {
+                if (this != &rhs)
+                {
+                    reset();
+                    m_vt = std::exchange(rhs.m_vt, nullptr);
+                    m_data = rhs.m_data;
+                    if (m_vt)
+                        m_vt->relocate(m_storage, rhs.m_storage);
+                }
+                return *this;
+            }
+            ~any_view() { reset(); }
+
+            Buffer address() const noexcept { return m_data; }
+
+        private:
+            void reset() noexcept
+            {
+                if (m_vt)
+                    m_vt->destroy(m_storage);
+                m_vt = nullptr;
+            }
+
+            const view_vtable *m_vt = nullptr;
+            Buffer m_data;
+            view_storage m_storage;
+        };
+    }
+
+    using any_rd_view = impl::any_view<const_buffer>;
+    using any_wr_view = impl::any_view<mutable_buffer>;
+
+    namespace impl
+    {
+        using device_storage = small_storage<8 * sizeof(void *)>;
+
+        struct device_vtable
+        {
+            device_caps caps;
+            void (*destroy)(device_storage &) noexcept;
+            void (*relocate)(device_storage &, device_storage &) noexcept;
+
+            long_size_t (*offset)(device_storage &, error_code_ptr);
+            long_size_t (*seek)(device_storage &, long_size_t, error_code_ptr);
+            mutable_buffer (*read)(device_storage &, mutable_buffer, error_code_ptr);
+            mutable_buffer (*read_at)(device_storage &, long_size_t, mutable_buffer, error_code_ptr);
+            bool (*is_eof)(device_storage &, error_code_ptr);
+            long_size_t (*size)(device_storage &, error_code_ptr);
+            any_rd_view (*view_rd)(device_storage &, long_offset_range, error_code_ptr);
+            const_buffer (*write)(device_storage &, const_buffer, error_code_ptr);
+            const_buffer (*write_at)(device_storage &, long_size_t, const_buffer, error_code_ptr);
+            void (*sync)(device_storage &, error_code_ptr);
+            long_size_t (*truncate)(device_storage &, long_size_t, error_code_ptr);
+            any_wr_view (*view_wr)(device_storage &, long_offset_range, error_code_ptr);
+            std::size_t (*read_vec)(device_storage &, mutable_buffers, error_code_ptr);
+            std::size_t (*write_vec)(device_storage &, const_buffers, error_code_ptr);
+            std::any (*getopt)(device_storage &, int, const std::any &, error_code_ptr);
+            std::any (*setopt)(device_storage &, int, const std::any &, const std::any &, error_code_ptr);
+            void (*advise)(device_storage &, long_offset_range, access_pattern, error_code_ptr);
+            long_size_t (*find_data)(device_storage &, long_size_t, error_code_ptr);
+            long_size_t (*find_hole)(device_storage &, long_size_t, error_code_ptr);
+            void (*punch_hole)(device_storage &, long_offset_range, error_code_ptr);
+            std::size_t (*block_size)(device_storage &);
+            std::size_t (*alignment)(device_storage &);
+        };
+
+        // stands in for an operation the device does not model
+        template <typename R, typename... Args>
+        R not_supported(device_storage &, Args..., error_code_ptr ec)
+        {
+            set_error_or_throw<io_exception>(ec, std::errc::function_not_supported);
+            if constexpr (!std::is_void_v<R>)
+                return R{};
+        }
+
+        template <typename D>
+        constexpr device_caps caps_of() noexcept
+        {
+            device_caps res = device_caps::none;
+            if constexpr (sequence<D &>)
+                res = res | device_caps::sequence;
+            if constexpr (random<D &>)
+                res = res | device_caps::random;
+            if constexpr (reader<D &>)
+                res = res | device_caps::reader;
+            if constexpr (positional_reader<D &>)
+                res = res | device_caps::positional_reader;
+            if constexpr (is_eofer<D &>)
+                res = res | device_caps::is_eofer;
+            if constexpr (sizer<D &>)
+                res = res | device_caps::sizer;
+            if constexpr (read_map<D &>)
+                res = res | device_caps::read_map;
+            if constexpr (writer<D &>)
+                res = res | device_caps::writer;
+            if constexpr (positional_writer<D &>)
+                res = res | device_caps::positional_writer;
+            if constexpr (syncer<D &>)
+                res = res | device_caps::syncer;
+            if constexpr (truncater<D &>)
+                res = res | device_caps::truncater;
+            if constexpr (write_map<D &>)
+                res = res | device_caps::write_map;
+            if constexpr (vec_reader<D &>)
+                res = res | device_caps::vec_reader;
+            if constexpr (vec_writer<D &>)
+                res = res | device_caps::vec_writer;
+            if constexpr (options<D &>)
+                res = res | device_caps::options;
+            if constexpr (advisor<D &>)
+                res = res | device_caps::advisor;
+            if constexpr (extent_finder<D &>)
+                res = res | device_caps::extent_finder;
+            if constexpr (hole_puncher<D &>)
+                res = res | device_caps::hole_puncher;
+            return res;
+        }
+
+        template <typename D>
+        constexpr device_vtable make_device_vtable() noexcept
+        {
+            device_vtable vt{
+                caps_of<D>(),
+                &device_storage::destroy<D>,
+                &device_storage::relocate<D>,
+                &not_supported<long_size_t>,
+                &not_supported<long_size_t, long_size_t>,
+                &not_supported<mutable_buffer, mutable_buffer>,
+                &not_supported<mutable_buffer, long_size_t, mutable_buffer>,
+                &not_supported<bool>,
+                &not_supported<long_size_t>,
+                &not_supported<any_rd_view, long_offset_range>,
+                &not_supported<const_buffer, const_buffer>,
+                &not_supported<const_buffer, long_size_t, const_buffer>,
+                &not_supported<void>,
+                &not_supported<long_size_t, long_size_t>,
+                &not_supported<any_wr_view, long_offset_range>,
+                &not_supported<std::size_t, mutable_buffers>,
+                &not_supported<std::size_t, const_buffers>,
+                &not_supported<std::any, int, const std::any &>,
+                &not_supported<std::any, int, const std::any &, const std::any &>,
+                [](device_storage &s, long_offset_range rng, access_pattern pattern, error_code_ptr ec) {
+                    io::advise(*s.get<D>(), rng, pattern, ec);
+                },
+                &not_supported<long_size_t, long_size_t>,
+                &not_supported<long_size_t, long_size_t>,
+                &not_supported<void, long_offset_range>,
+                [](device_storage &s) -> std::size_t { return io::get_option<block_size_option>(*s.get<D>()); },
+                [](device_storage &s) -> std::size_t { return io::get_option<alignment_option>(*s.get<D>()); },
+            };
+            if constexpr (sequence<D &>)
+                vt.offset = [](device_storage &s, error_code_ptr ec) -> long_size_t { return io::offset(*s.get<D>(), ec); };
+            if constexpr (random<D &>)
+                vt.seek = [](device_storage &s, long_size_t off, error_code_ptr ec) -> long_size_t {
+                    return io::seek(*s.get<D>(), off, ec);
+                };
+            if constexpr (reader<D &>)
+                vt.read = [](device_storage &s, mutable_buffer buf, error_code_ptr ec) -> mutable_buffer {
+                    return io::read(*s.get<D>(), buf, ec);
+                };
+            if constexpr (positional_reader<D &>)
+                vt.read_at = [](device_storage &s, long_size_t off, mutable_buffer buf, error_code_ptr ec) -> mutable_buffer {
+                    return io::read_at(*s.get<D>(), off, buf, ec);
+                };
+            if constexpr (is_eofer<D &>)
+                vt.is_eof = [](device_storage &s, error_code_ptr ec) -> bool { return io::is_eof(*s.get<D>(), ec); };
+            if constexpr (sizer<D &>)
+                vt.size = [](device_storage &s, error_code_ptr ec) -> long_size_t { return io::size(*s.get<D>(), ec); };
+            if constexpr (read_map<D &>)
+                vt.view_rd = [](device_storage &s, long_offset_range rng, error_code_ptr ec) -> any_rd_view {
+                    return any_rd_view(io::view_rd(*s.get<D>(), rng, ec));
+                };
+            if constexpr (writer<D &>)
+                vt.write = [](device_storage &s, const_buffer buf, error_code_ptr ec) -> const_buffer {
+                    return io::write(*s.get<D>(), buf, ec);
+                };
+            if constexpr (positional_writer<D &>)
+                vt.write_at = [](device_storage &s, long_size_t off, const_buffer buf, error_code_ptr ec) -> const_buffer {
+                    return io::write_at(*s.get<D>(), off, buf, ec);
+                };
+            if constexpr (syncer<D &>)
+                vt.sync = [](device_storage &s, error_code_ptr ec) { io::sync(*s.get<D>(), ec); };
+            if constexpr (truncater<D &>)
+                vt.truncate = [](device_storage &s, long_size_t n, error_code_ptr ec) -> long_size_t {
+                    return io::truncate(*s.get<D>(), n, ec);
+                };
+            if constexpr (write_map<D &>)
+                vt.view_wr = [](device_storage &s, long_offset_range rng, error_code_ptr ec) -> any_wr_view {
+                    return any_wr_view(io::view_wr(*s.get<D>(), rng, ec));
+                };
+            if constexpr (vec_reader<D &>)
+                vt.read_vec = [](device_storage &s, mutable_buffers bufs, error_code_ptr ec) -> std::size_t {
+                    return io::read_vec(*s.get<D>(), bufs, ec);
+                };
+            if constexpr (vec_writer<D &>)
+                vt.write_vec = [](device_storage &s, const_buffers bufs, error_code_ptr ec) -> std::size_t {
+                    return io::write_vec(*s.get<D>(), bufs, ec);
+                };
+            if constexpr (options<D &>)
+            {
+                vt.getopt = [](device_storage &s, int id, const std::any &optdata, error_code_ptr ec) -> std::any {
+                    return io::getopt(*s.get<D>(), id, optdata, ec);
+                };
+                vt.setopt = [](device_storage &s, int id, const std::any &optdata, const std::any &indata,
+                               error_code_ptr ec) -> std::any {
+                    return io::setopt(*s.get<D>(), id, optdata, indata, ec);
+                };
+            }
+            if constexpr (extent_finder<D &>)
+            {
+                vt.find_data = [](device_storage &s, long_size_t off, error_code_ptr ec) -> long_size_t {
+                    return io::find_data(*s.get<D>(), off, ec);
+                };
+                vt.find_hole = [](device_storage &s, long_size_t off, error_code_ptr ec) -> long_size_t {
+                    return io::find_hole(*s.get<D>(), off, ec);
+                };
+            }
+            else if constexpr (sizer<D &>)
+            { // not sparse, the whole device is data
+                vt.find_data = [](device_storage &s, long_size_t off, error_code_ptr ec) -> long_size_t {
+                    return std::min(off, io::size(*s.get<D>(), ec));
+                };
+                vt.find_hole = [](device_storage &s, long_size_t off, error_code_ptr ec) -> long_size_t {
+                    return std::max(off, io::size(*s.get<D>(), ec));
+                };
+            }
+            if constexpr (hole_puncher<D &>)
+                vt.punch_hole = [](device_storage &s, long_offset_range rng, error_code_ptr ec) {
+                    io::punch_hole(*s.get<D>(), rng, ec);
+                };
+            return vt;
+        }
+
+        template <typename D>
+        inline constexpr device_vtable device_vtable_for = make_device_vtable<D>();
+    }
+
+    // Type erased device, owning a device of any type.
+    // Every operation goes through one static table per device type, small devices such as
+    // shift_device/sub_device are stored inline without allocation. The wrapper models all the
+    // io concepts, operations the device does not support report function_not_supported,
+    // caps()/supports() tell them apart without a call, io algorithms check them through io::supports.
+    // Advice the device does not act on is ignored, as io::advise does, a device which is not sparse
+    // is one data extent, and block_size_option/alignment_option report the values of the device.
+    class any_device
+    {
+    public:
+        any_device() noexcept = default;
+
+        template <typename Device>
+            requires(!std::is_same_v<std::remove_cvref_t<Device>, any_device>)
+        explicit any_device(Device &&d)
+        {
+            emplace<std::remove_cvref_t<Device>>(std::forward<Device>(d));
+        }
+
+        template <typename Device, typename... Args>
+        explicit any_device(std::in_place_type_t<Device>, Args &&...args)
+        {
+            emplace<Device>(std::forward<Args>(args)...);
+        }
+
+        any_device(any_device &&rhs) noexcept : m_vt(std::exchange(rhs.m_vt, nullptr))
+        {
+            if (m_vt)
+                m_vt->relocate(m_storage, rhs.m_storage);
+        }
+        any_device &operator=(any_device &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                reset();
+                m_vt = std::exchange(rhs.m_vt, nullptr);
+                if (m_vt)
+                    m_vt->relocate(m_storage, rhs.m_storage);
+            }
+            return *this;
+        }
+        ~any_device() { reset(); }
+
+        template <typename Device, typename... Args>
+        Device &emplace(Args &&...args)
+        {
+            reset();
+            m_storage.emplace<Device>(std::forward<Args>(args)...);
+            m_vt = &impl::device_vtable_for<Device>;
+            return *m_storage.get<Device>();
+        }
+
+        void reset() noexcept
+        {
+            if (m_vt)
+                m_vt->destroy(m_storage);
+            m_vt = nullptr;
+        }
+
+        bool has_value() const noexcept { return m_vt != nullptr; }
+        device_caps caps() const noexcept { return m_vt ? m_vt->caps : device_caps::none; }
+        bool supports(device_caps c) const noexcept { return has_caps(caps(), c); }
+
+        template <typename Device>
+        static constexpr bool stored_inline = impl::device_storage::is_inline<Device>;
+
+        // the wrapped device if it is a Device, nullptr otherwise
+        template <typename Device>
+        Device *target() noexcept
+        {
+            return m_vt == &impl::device_vtable_for<Device> ? m_storage.get<Device>() : nullptr;
+        }
+
+        long_size_t offset(error_code_ptr ec = {})
+        { // sequence
+            return table().offset(m_storage, ec);
+        }
+
+        long_size_t seek(long_size_t off, error_code_ptr ec = {})
+        { // random
+            return table().seek(m_storage, off, ec);
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            return table().read(m_storage, buf, ec);
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+        { // positional_reader
+            return table().read_at(m_storage, off, buf, ec);
+        }
+
+        bool is_eof(error_code_ptr ec = {})
+        { // is_eofer
+            return table().is_eof(m_storage, ec);
+        }
+
+        long_size_t size(error_code_ptr ec = {})
+        { // sizer
+            return table().size(m_storage, ec);
+        }
+
+        any_rd_view view_rd(long_offset_range rng, error_code_ptr ec = {})
+        { // read_map
+            return table().view_rd(m_storage, rng, ec);
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            return table().write(m_storage, buf, ec);
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            return table().write_at(m_storage, off, buf, ec);
+        }
+
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            table().sync(m_storage, ec);
+        }
+
+        long_size_t truncate(long_size_t n, error_code_ptr ec = {})
+        { // truncater
+            return table().truncate(m_storage, n, ec);
+        }
+
+        any_wr_view view_wr(long_offset_range rng, error_code_ptr ec = {})
+        { // write_map
+            return table().view_wr(m_storage, rng, ec);
+        }
+
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+        { // vec_reader
+            return table().read_vec(m_storage, bufs, ec);
+        }
+
+        std::size_t write_vec(const_buffers bufs, error_code_ptr ec = {})
+        { // vec_writer
+            return table().write_vec(m_storage, bufs, ec);
+        }
+
+        std::any getopt(int id, const std::any &optdata, error_code_ptr ec = {})
+        { // options
+            return table().getopt(m_storage, id, optdata, ec);
+        }
+
+        std::any setopt(int id, const std::any &optdata, const std::any &indata, error_code_ptr ec = {})
+        { // options
+            return table().setopt(m_storage, id, optdata, indata, ec);
+        }
+
+        void advise(long_offset_range rng, access_pattern pattern, error_code_ptr ec = {})
+        { // advisor
+            table().advise(m_storage, rng, pattern, ec);
+        }
+
+        long_size_t find_data(long_size_t off, error_code_ptr ec = {})
+        { // extent_finder
+            return table().find_data(m_storage, off, ec);
+        }
+
+        long_size_t find_hole(long_size_t off, error_code_ptr ec = {})
+        { // extent_finder
+            return table().find_hole(m_storage, off, ec);
+        }
+
+        void punch_hole(long_offset_range rng, error_code_ptr ec = {})
+        { // hole_puncher
+            table().punch_hole(m_storage, rng, ec);
+        }
+
+        std::size_t get_option(block_size_option) const
+        {
+            return table().block_size(const_cast<impl::device_storage &>(m_storage));
+        }
+
+        std::size_t get_option(alignment_option) const
+        {
+            return table().alignment(const_cast<impl::device_storage &>(m_storage));
+        }
+
+    private:
+        const impl::device_vtable &table() const noexcept
+        {
+            return m_vt ? *m_vt : impl::device_vtable_for<empty_slot>;
+        }
+
+        struct empty_slot
+        {
+        };
+
+        const impl::device_vtable *m_vt = nullptr;
+        impl::device_storage m_storage;
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_ANY_DEVICE_H
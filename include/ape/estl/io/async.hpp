@@ -0,0 +1,188 @@
+#pragma once
+#ifndef APE_ESTL_IO_ASYNC_H
+#define APE_ESTL_IO_ASYNC_H
+#include <ape/estl/io/iocore.hpp>
+#include <ape/estl/thread_pool.hpp>
+#include <coroutine>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    // result of an awaited io operation, usable with structured bindings:
+    //     auto [data, ec] = co_await async_read(device, buf);
+    template <typename T>
+    struct async_result
+    {
+        T value;
+        error_code error;
+    };
+
+    template <typename Awaitable, typename T>
+    concept awaitable_of = requires(Awaitable &&a, std::coroutine_handle<> h) {
+        {
+            a.await_ready()
+        } -> std::convertible_to<bool>;
+        a.await_suspend(h);
+        {
+            a.await_resume()
+        } -> std::convertible_to<T>;
+    };
+
+    // Interface List:
+    // [ async_reader, async_writer ]
+
+    // async_read && async_reader
+    template <typename Device>
+        requires requires(Device &&device, mutable_buffer buf) {
+            {
+                device.async_read(buf)
+            } -> awaitable_of<async_result<mutable_buffer>>;
+        }
+    decltype(auto) async_read(Device &&device, mutable_buffer buf)
+    {
+        return device.async_read(buf);
+    }
+    // awaits: read in data and error
+    template <typename Device>
+    concept async_reader = requires(Device &&device, mutable_buffer buf) {
+        {
+            async_read(device, buf)
+        } -> awaitable_of<async_result<mutable_buffer>>;
+    };
+
+    // async_write && async_writer
+    template <typename Device>
+        requires requires(Device &&device, const_buffer buf) {
+            {
+                device.async_write(buf)
+            } -> awaitable_of<async_result<const_buffer>>;
+        }
+    decltype(auto) async_write(Device &&device, const_buffer buf)
+    {
+        return device.async_write(buf);
+    }
+    // awaits: not written data and error
+    template <typename Device>
+    concept async_writer = requires(Device &&device, const_buffer buf) {
+        {
+            async_write(device, buf)
+        } -> awaitable_of<async_result<const_buffer>>;
+    };
+
+    // awaitable for an operation already done, never suspends
+    template <typename T>
+    struct ready_awaitable
+    {
+        T result;
+
+        bool await_ready() const noexcept { return true; }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        T await_resume() noexcept { return std::move(result); }
+    };
+
+    // Lift a synchronous device: the operation runs when async_read/async_write is called,
+    // the awaitable completes inline. Best for memory devices, where suspending costs more than the copy.
+    template <typename Device>
+        requires reader<Device> || writer<Device>
+    class inline_async
+    {
+        Device &m_device;
+
+    public:
+        explicit inline_async(Device &d) noexcept : m_device(d) {}
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+
+        ready_awaitable<async_result<mutable_buffer>> async_read(mutable_buffer buf)
+            requires reader<Device>
+        { // async_reader
+            async_result<mutable_buffer> res;
+            res.value = io::read(m_device, buf, error_code_ptr(&res.error));
+            return {res};
+        }
+
+        ready_awaitable<async_result<const_buffer>> async_write(const_buffer buf)
+            requires writer<Device>
+        { // async_writer
+            async_result<const_buffer> res;
+            res.value = io::write(m_device, buf, error_code_ptr(&res.error));
+            return {res};
+        }
+    };
+
+    // Lift a synchronous device: the operation runs on a thread pool while the coroutine is suspended.
+    // The coroutine resumes on the pool thread, or on Executor::post when an executor is given.
+    // Only one operation per device may be in flight at a time.
+    template <typename Device, typename Executor = thread_pool>
+        requires reader<Device> || writer<Device>
+    class pooled_async
+    {
+        Device &m_device;
+        thread_pool &m_pool;
+        Executor *m_resume_on;
+
+        template <typename Buffer, typename Op>
+        struct awaiter
+        {
+            pooled_async *self;
+            Buffer buf;
+            Op op;
+            async_result<Buffer> result{};
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                self->m_pool.post([this, h]
+                                  {
+                                      result.value = op(self->m_device, buf, error_code_ptr(&result.error));
+                                      if (self->m_resume_on)
+                                          self->m_resume_on->post([h] { h.resume(); });
+                                      else
+                                          h.resume(); });
+            }
+            async_result<Buffer> await_resume() noexcept { return std::move(result); }
+        };
+
+        struct do_read
+        {
+            mutable_buffer operator()(Device &d, mutable_buffer buf, error_code_ptr ec) const
+            {
+                return io::read(d, buf, ec);
+            }
+        };
+        struct do_write
+        {
+            const_buffer operator()(Device &d, const_buffer buf, error_code_ptr ec) const
+            {
+                return io::write(d, buf, ec);
+            }
+        };
+
+    public:
+        pooled_async(Device &d, thread_pool &pool, Executor *resume_on = nullptr) noexcept
+            : m_device(d), m_pool(pool), m_resume_on(resume_on) {}
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+
+        auto async_read(mutable_buffer buf)
+            requires reader<Device>
+        { // async_reader
+            return awaiter<mutable_buffer, do_read>{this, buf, {}};
+        }
+
+        auto async_write(const_buffer buf)
+            requires writer<Device>
+        { // async_writer
+            return awaiter<const_buffer, do_write>{this, buf, {}};
+        }
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_ASYNC_H
@@ -0,0 +1,613 @@
+#pragma once
+#ifndef APE_ESTL_IO_ASYNC_FILE_H
+#define APE_ESTL_IO_ASYNC_FILE_H
+#include <ape/estl/io/file.hpp>
+#include <ape/estl/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <limits>
+#include <mutex>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define APE_ESTL_IO_HAS_URING 1
+#else
+#define APE_ESTL_IO_HAS_URING 0
+#endif
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    using completion_token = std::uint64_t;
+
+    struct completion
+    {
+        completion_token token{0};
+        std::size_t bytes{0}; // transferred bytes
+        error_code error;
+    };
+
+    enum class async_backend
+    {
+        automatic, // io_uring when the kernel allows it, otherwise thread_pool
+        uring,
+        thread_pool,
+    };
+
+    namespace impl
+    {
+#if APE_ESTL_IO_HAS_URING
+        // Minimal io_uring binding on the raw system calls, single submitter and single reaper.
+        class uring
+        {
+        public:
+            uring() noexcept = default;
+            uring(const uring &) = delete;
+            uring &operator=(const uring &) = delete;
+            ~uring() { close(); }
+
+            bool open(unsigned entries, error_code &ec) noexcept
+            {
+                ::io_uring_params p{};
+                int fd = int(::syscall(__NR_io_uring_setup, entries, &p));
+                if (fd < 0)
+                {
+                    ec = last_system_error();
+                    return false;
+                }
+                m_fd = fd;
+
+                m_sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+                m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(::io_uring_cqe);
+                bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                    m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+
+                m_sq_ring = map(m_sq_size, IORING_OFF_SQ_RING);
+                m_cq_ring = single_mmap ? m_sq_ring : map(m_cq_size, IORING_OFF_CQ_RING);
+                m_sqes_size = p.sq_entries * sizeof(::io_uring_sqe);
+                auto sqes = map(m_sqes_size, IORING_OFF_SQES);
+                if (!m_sq_ring || !m_cq_ring || !sqes)
+                {
+                    ec = last_system_error();
+                    if (sqes)
+                        ::munmap(sqes, m_sqes_size);
+                    close();
+                    return false;
+                }
+
+                auto sq = static_cast<char *>(m_sq_ring);
+                m_sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+                m_sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+                m_sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+                m_sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+                m_sq_entries = p.sq_entries;
+                m_sqes = static_cast<::io_uring_sqe *>(sqes);
+
+                auto cq = static_cast<char *>(m_cq_ring);
+                m_cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+                m_cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+                m_cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<::io_uring_cqe *>(cq + p.cq_off.cqes);
+                m_cq_entries = p.cq_entries;
+
+                ec.clear();
+                return true;
+            }
+
+            void close() noexcept
+            {
+                if (m_sqes)
+                    ::munmap(m_sqes, m_sqes_size);
+                if (m_cq_ring && m_cq_ring != m_sq_ring)
+                    ::munmap(m_cq_ring, m_cq_size);
+                if (m_sq_ring)
+                    ::munmap(m_sq_ring, m_sq_size);
+                if (m_fd >= 0)
+                    ::close(m_fd);
+                m_sqes = nullptr;
+                m_sq_ring = m_cq_ring = nullptr;
+                m_fd = -1;
+            }
+
+            bool is_open() const noexcept { return m_fd >= 0; }
+
+            // the completion queue never overflows while in flight requests stay below capacity
+            unsigned capacity() const noexcept { return m_cq_entries; }
+
+            // queue one request without a system call, false when the submission queue is full
+            bool push(std::uint8_t opcode, int fd, long_size_t off, const void *addr, std::uint32_t len,
+                      completion_token token) noexcept
+            {
+                unsigned tail = *m_sq_tail;
+                unsigned head = std::atomic_ref<unsigned>(*m_sq_head).load(std::memory_order_acquire);
+                if (tail - head == m_sq_entries)
+                    return false;
+
+                unsigned idx = tail & m_sq_mask;
+                auto &sqe = m_sqes[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = opcode;
+                sqe.fd = fd;
+                sqe.off = off;
+                sqe.addr = reinterpret_cast<std::uintptr_t>(addr);
+                sqe.len = len;
+                sqe.user_data = token;
+                m_sq_array[idx] = idx;
+                std::atomic_ref<unsigned>(*m_sq_tail).store(tail + 1, std::memory_order_release);
+                ++m_to_submit;
+                return true;
+            }
+
+            // submit all queued requests in one system call, and wait for min_complete completions
+            bool enter(unsigned min_complete, error_code &ec) noexcept
+            {
+                unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+                for (;;)
+                {
+                    int r = int(::syscall(__NR_io_uring_enter, m_fd, m_to_submit, min_complete, flags, nullptr, 0));
+                    if (r >= 0)
+                    {
+                        m_to_submit -= unsigned(r);
+                        ec.clear();
+                        return true;
+                    }
+                    if (errno != EINTR)
+                    {
+                        ec = last_system_error();
+                        return false;
+                    }
+                }
+            }
+
+            bool has_unsubmitted() const noexcept { return m_to_submit != 0; }
+
+            // whether the kernel implements every opcode of ops. IORING_OP_READ/WRITE came in 5.6,
+            // along with IORING_REGISTER_PROBE, so older kernels fail the probe and support none.
+            bool supports(std::initializer_list<std::uint8_t> ops) const noexcept
+            {
+                constexpr unsigned probe_ops = 256;
+                alignas(::io_uring_probe) std::byte storage[sizeof(::io_uring_probe) +
+                                                            probe_ops * sizeof(::io_uring_probe_op)]{};
+                auto probe = reinterpret_cast<::io_uring_probe *>(storage);
+                if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, probe_ops) < 0)
+                    return false;
+                for (auto op : ops)
+                {
+                    if (op > probe->last_op || op >= probe->ops_len ||
+                        (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+                        return false;
+                }
+                return true;
+            }
+
+            // call on_completion(token, result) for at most limit completions
+            template <typename F>
+            std::size_t reap(std::size_t limit, F &&on_completion) noexcept
+            {
+                unsigned head = *m_cq_head;
+                unsigned tail = std::atomic_ref<unsigned>(*m_cq_tail).load(std::memory_order_acquire);
+                std::size_t n = 0;
+                for (; head != tail && n < limit; ++head, ++n)
+                {
+                    auto &cqe = m_cqes[head & m_cq_mask];
+                    on_completion(completion_token(cqe.user_data), cqe.res);
+                }
+                std::atomic_ref<unsigned>(*m_cq_head).store(head, std::memory_order_release);
+                return n;
+            }
+
+        private:
+            void *map(std::size_t size, off_t offset) noexcept
+            {
+                void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+                return p == MAP_FAILED ? nullptr : p;
+            }
+
+            int m_fd{-1};
+            void *m_sq_ring{nullptr};
+            void *m_cq_ring{nullptr};
+            std::size_t m_sq_size{0}, m_cq_size{0}, m_sqes_size{0};
+
+            unsigned *m_sq_head{nullptr};
+            unsigned *m_sq_tail{nullptr};
+            unsigned *m_sq_array{nullptr};
+            unsigned m_sq_mask{0};
+            unsigned m_sq_entries{0};
+            ::io_uring_sqe *m_sqes{nullptr};
+            unsigned m_to_submit{0};
+
+            unsigned *m_cq_head{nullptr};
+            unsigned *m_cq_tail{nullptr};
+            unsigned m_cq_mask{0};
+            unsigned m_cq_entries{0};
+            ::io_uring_cqe *m_cqes{nullptr};
+        };
+#endif
+        // completions produced by the worker threads of the fallback backend
+        struct completion_queue
+        {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<completion> done;
+        };
+    }
+
+    // Asynchronous file device.
+    // submit_read_at/submit_write_at queue requests and return a token, poll/wait reap completions
+    // in batches. Requests go to io_uring, submitted with one system call per poll/wait; when io_uring
+    // is not available, a thread pool runs pread/pwrite. Buffers must stay alive until completion.
+    // The synchronous facade waits for its own request and keeps other completions for poll/wait.
+    // The device is not thread safe, it expects a single submitting thread.
+    // imp [ sequence, forward, random ]
+    //     [ reader, positional_reader, is_eofer, sizer ]
+    //     [ writer, positional_writer, syncer, truncater ]
+    class async_file_device
+    {
+    public:
+        static constexpr unsigned default_queue_depth = 256;
+        static constexpr std::size_t default_pool_threads = 4;
+
+        explicit async_file_device(file_device file, async_backend backend = async_backend::automatic,
+                                   unsigned queue_depth = default_queue_depth, error_code_ptr ec = {})
+            : m_file(std::move(file))
+        {
+            setup(backend, queue_depth, ec);
+        }
+
+        async_file_device(const char *path, open_mode mode, async_backend backend = async_backend::automatic,
+                          error_code_ptr ec = {})
+            : m_file(path, mode, ec)
+        {
+            if (!has_error(ec))
+                setup(backend, default_queue_depth, ec);
+        }
+        async_file_device(const std::string &path, open_mode mode, async_backend backend = async_backend::automatic,
+                          error_code_ptr ec = {})
+            : async_file_device(path.c_str(), mode, backend, ec) {}
+
+        async_file_device(const async_file_device &) = delete;
+        async_file_device &operator=(const async_file_device &) = delete;
+
+        ~async_file_device()
+        {
+            // the kernel or the workers may still write into caller buffers, wait for all of them
+            completion scratch[16];
+            while (m_in_flight != 0)
+            {
+                error_code ec;
+                if (wait_some(scratch, 1, ec) == 0 && ec)
+                    break;
+            }
+        }
+
+        async_backend backend() const noexcept { return m_backend; }
+        int native_handle() const noexcept { return m_file.native_handle(); }
+        using native_file_tag = void; // io::copy may copy_file_range into it
+
+        // requests submitted and not reaped yet
+        std::size_t in_flight() const noexcept { return m_in_flight + m_stash.size(); }
+
+        completion_token submit_read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+        {
+            return submit(false, off, buf.data(), buf.size(), ec);
+        }
+
+        completion_token submit_write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        {
+            return submit(true, off, buf.data(), buf.size(), ec);
+        }
+
+        // reap available completions without blocking, return the count stored into out
+        std::size_t poll(std::span<completion> out, error_code_ptr ec = {})
+        {
+            error_code e;
+            auto n = take_stash(out);
+            n += reap_some(out.subspan(n), e);
+            set_error_or_throw<io_exception>(ec, e);
+            return n;
+        }
+
+        // block until at least min_complete completions (capped by out and in_flight) are stored into out
+        std::size_t wait(std::span<completion> out, std::size_t min_complete = 1, error_code_ptr ec = {})
+        {
+            min_complete = std::min({min_complete, out.size(), in_flight()});
+            auto n = take_stash(out);
+            error_code e;
+            while (n < min_complete && !e)
+                n += wait_some(out.subspan(n), min_complete - n, e);
+            set_error_or_throw<io_exception>(ec, e);
+            return n;
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        long_size_t seek(long_size_t offset, error_code_ptr ec = {})
+        { // random
+            if (!impl::in_off_t_range(offset))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return m_pos;
+            }
+            clear_error(ec);
+            return m_pos = offset;
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+        { // is_eofer
+            auto s = m_file.size(ec);
+            return has_error(ec) || m_pos >= s;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+        { // sizer
+            return m_file.size(ec);
+        }
+
+        long_size_t truncate(long_size_t size, error_code_ptr ec = {})
+        { // truncater
+            return m_file.truncate(size, ec);
+        }
+
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            m_file.sync(ec);
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+        { // positional_reader
+            return buf.first(transfer(false, off, buf.data(), buf.size(), ec));
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            return buf.subspan(transfer(true, off, buf.data(), buf.size(), ec));
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            auto res = read_at(m_pos, buf, ec);
+            m_pos += res.size();
+            return res;
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            auto res = write_at(m_pos, buf, ec);
+            m_pos += buf.size() - res.size();
+            return res;
+        }
+
+    private:
+        void setup(async_backend backend, unsigned queue_depth, error_code_ptr ec)
+        {
+            clear_error(ec);
+#if APE_ESTL_IO_HAS_URING
+            if (backend != async_backend::thread_pool)
+            {
+                error_code e;
+                if (m_ring.open(std::max(queue_depth, 1u), e))
+                {
+                    if (m_ring.supports({IORING_OP_READ, IORING_OP_WRITE}))
+                    {
+                        m_backend = async_backend::uring;
+                        return;
+                    }
+                    m_ring.close();
+                    e = std::make_error_code(std::errc::function_not_supported);
+                }
+                if (backend == async_backend::uring)
+                {
+                    set_error_or_throw<io_exception>(ec, e);
+                    return;
+                }
+            }
+#else
+            if (backend == async_backend::uring)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::function_not_supported);
+                return;
+            }
+#endif
+            unused(queue_depth);
+            m_backend = async_backend::thread_pool;
+            m_pool = std::make_unique<thread_pool>(default_pool_threads);
+        }
+
+        completion_token submit(bool is_write, long_size_t off, const std::byte *data, std::size_t n,
+                                error_code_ptr ec)
+        {
+            if (!impl::in_off_t_range(off))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return 0;
+            }
+            auto token = m_next_token++;
+            error_code e;
+#if APE_ESTL_IO_HAS_URING
+            if (m_backend == async_backend::uring)
+            {
+                // keep the completion queue from overflowing
+                while (m_in_flight >= m_ring.capacity() && !e)
+                    stash_some(e);
+
+                auto len = std::uint32_t(std::min<std::size_t>(n, std::numeric_limits<std::uint32_t>::max()));
+                auto op = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+                while (!e && !m_ring.push(op, m_file.native_handle(), off, data, len, token))
+                    m_ring.enter(0, e);
+                if (e)
+                {
+                    set_error_or_throw<io_exception>(ec, e);
+                    return 0;
+                }
+                ++m_in_flight;
+                clear_error(ec);
+                return token;
+            }
+#endif
+            if (!m_pool) // the open or the setup failed, no backend to take requests
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::bad_file_descriptor);
+                return 0;
+            }
+            m_pool->post([queue = &m_queue, fd = m_file.native_handle(), is_write, off, data, n, token]
+                         {
+                             completion c{token, 0, {}};
+                             file_device file(fd, false);
+                             if (is_write)
+                                 c.bytes = n - file.write_at(off, {data, n}, error_code_ptr(&c.error)).size();
+                             else
+                                 c.bytes = file.read_at(off, {const_cast<std::byte *>(data), n}, error_code_ptr(&c.error)).size();
+                             {
+                                 std::lock_guard lock(queue->mutex);
+                                 queue->done.push_back(c);
+                             }
+                             queue->ready.notify_one();
+                         });
+            ++m_in_flight;
+            clear_error(ec);
+            return token;
+        }
+
+        // submit and complete one request at a time until all data is transferred, end of file or error
+        std::size_t transfer(bool is_write, long_size_t off, const std::byte *data, std::size_t n,
+                             error_code_ptr ec)
+        {
+            std::size_t done = 0;
+            while (done < n)
+            {
+                auto token = submit(is_write, off + done, data + done, n - done, ec);
+                if (has_error(ec))
+                    return done;
+
+                auto c = complete(token);
+                if (c.error)
+                {
+                    set_error_or_throw<io_exception>(ec, c.error);
+                    return done;
+                }
+                if (c.bytes == 0)
+                    break;
+                done += c.bytes;
+            }
+            clear_error(ec);
+            return done;
+        }
+
+        completion complete(completion_token token)
+        {
+            for (auto it = m_stash.begin(); it != m_stash.end(); ++it)
+            {
+                if (it->token == token)
+                {
+                    auto c = *it;
+                    m_stash.erase(it);
+                    return c;
+                }
+            }
+            for (;;)
+            {
+                completion c;
+                error_code e;
+                if (wait_some({&c, 1}, 1, e) == 0)
+                {
+                    if (e)
+                        return {token, 0, e};
+                    continue;
+                }
+                if (c.token == token)
+                    return c;
+                m_stash.push_back(c);
+            }
+        }
+
+        std::size_t take_stash(std::span<completion> out)
+        {
+            auto n = std::min(out.size(), m_stash.size());
+            std::copy_n(m_stash.begin(), n, out.begin());
+            m_stash.erase(m_stash.begin(), m_stash.begin() + std::ptrdiff_t(n));
+            return n;
+        }
+
+        void stash_some(error_code &e)
+        {
+            completion scratch[16];
+            auto n = wait_some(scratch, 1, e);
+            m_stash.insert(m_stash.end(), scratch, scratch + n);
+        }
+
+        std::size_t reap_some(std::span<completion> out, error_code &e)
+        {
+            if (out.empty() || m_in_flight == 0)
+                return 0;
+#if APE_ESTL_IO_HAS_URING
+            if (m_backend == async_backend::uring)
+            {
+                if (m_ring.has_unsubmitted() && !m_ring.enter(0, e))
+                    return 0;
+                auto n = m_ring.reap(out.size(), [out, i = std::size_t(0)](completion_token token, int res) mutable
+                                     {
+                                         if (res < 0)
+                                             out[i++] = {token, 0, error_code(-res, std::system_category())};
+                                         else
+                                             out[i++] = {token, std::size_t(res), {}};
+                                     });
+                m_in_flight -= n;
+                return n;
+            }
+#endif
+            std::lock_guard lock(m_queue.mutex);
+            auto n = std::min(out.size(), m_queue.done.size());
+            std::copy_n(m_queue.done.begin(), n, out.begin());
+            m_queue.done.erase(m_queue.done.begin(), m_queue.done.begin() + std::ptrdiff_t(n));
+            m_in_flight -= n;
+            return n;
+        }
+
+        std::size_t wait_some(std::span<completion> out, std::size_t min_complete, error_code &e)
+        {
+            min_complete = std::min({min_complete, out.size(), m_in_flight});
+            if (min_complete == 0)
+                return 0;
+#if APE_ESTL_IO_HAS_URING
+            if (m_backend == async_backend::uring)
+            {
+                if (!m_ring.enter(unsigned(min_complete), e))
+                    return 0;
+                return reap_some(out, e);
+            }
+#endif
+            {
+                std::unique_lock lock(m_queue.mutex);
+                m_queue.ready.wait(lock, [&] { return m_queue.done.size() >= min_complete; });
+            }
+            return reap_some(out, e);
+        }
+
+        file_device m_file;
+        long_size_t m_pos{0};
+        async_backend m_backend{async_backend::thread_pool};
+#if APE_ESTL_IO_HAS_URING
+        impl::uring m_ring;
+#endif
+        impl::completion_queue m_queue;
+        std::unique_ptr<thread_pool> m_pool;
+        std::deque<completion> m_stash;
+        completion_token m_next_token{1};
+        std::size_t m_in_flight{0};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_ASYNC_FILE_H
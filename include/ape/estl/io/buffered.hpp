@@ -0,0 +1,488 @@
+#pragma once
+#ifndef APE_ESTL_IO_BUFFERED_H
+#define APE_ESTL_IO_BUFFERED_H
+#include <ape/estl/io/iocore.hpp>
+#include <ape/estl/memory.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    inline constexpr std::size_t default_block_size = 64 * 1024;
+
+    namespace impl
+    {
+        // uninitialized block buffer aligned as the device requires (alignment_option)
+        using block_buffer = std::vector<std::byte, default_init_allocator<std::byte, aligned_allocator<std::byte>>>;
+
+        inline std::size_t round_up(std::size_t n, std::size_t align) noexcept
+        {
+            return (n + align - 1) / align * align;
+        }
+
+        inline bool is_aligned(const void *p, std::size_t align) noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+        }
+    }
+
+    // Batch small reads into block sized reads of the underlying device.
+    // peek/consume expose the internal buffer, so parsers can work in place.
+    // Large reads bypass the buffer once it is drained.
+    // On devices requiring an alignment (direct io) the block is a multiple of it, device reads
+    // start at aligned offsets into aligned memory, and only aligned callers' buffers are bypassed:
+    // the unaligned rest goes through the block, which acts as bounce buffer.
+    // imp [ sequence, forward, random ] [ reader, is_eofer, sizer ]
+    template <reader Device>
+    class buffered_reader
+    {
+        Device &m_device;
+        std::size_t m_align;
+        impl::block_buffer m_buffer;
+        std::size_t m_begin{0}, m_end{0}; // unread data in m_buffer, m_end matches the device offset
+
+    public:
+        explicit buffered_reader(Device &d, std::size_t block_size = default_block_size)
+            : m_device(d), m_align(std::max<std::size_t>(io::get_option<alignment_option>(d), 1)),
+              m_buffer(impl::round_up(std::max<std::size_t>(block_size, 1), m_align),
+                       aligned_allocator<std::byte>(m_align))
+        {
+        }
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+        const Device &underlying() const noexcept
+        {
+            return m_device;
+        }
+
+        std::size_t block_size() const noexcept { return m_buffer.size(); }
+        std::size_t get_option(block_size_option) const noexcept { return block_size(); }
+
+        // size of the data already read from the device but not consumed yet
+        std::size_t buffered() const noexcept { return m_end - m_begin; }
+
+        // return: at least n bytes unless end of device or error, never consume them.
+        // The result is valid until the next non-const call.
+        const_buffer peek(std::size_t n, error_code_ptr ec = {})
+        {
+            clear_error(ec);
+            if (buffered() < n)
+            {
+                if (m_buffer.size() - m_begin < n)
+                {
+                    // move by whole alignment units, so m_end stays aligned
+                    auto shift = m_begin - m_begin % m_align;
+                    std::memmove(m_buffer.data(), m_buffer.data() + shift, m_end - shift);
+                    m_end -= shift;
+                    m_begin -= shift;
+                    if (m_buffer.size() < m_begin + n)
+                        m_buffer.resize(impl::round_up(m_begin + n, m_align));
+                }
+                while (buffered() < n && m_end < m_buffer.size())
+                {
+                    auto got = device_read(mutable_buffer(m_buffer).subspan(m_end), ec);
+                    m_end += got;
+                    if (got == 0 || has_error(ec))
+                        break;
+                }
+            }
+            return {m_buffer.data() + m_begin, std::min(n, buffered())};
+        }
+
+        void consume(std::size_t n) noexcept
+        {
+            APE_Expects(n <= buffered());
+            m_begin += n;
+            if (m_begin == m_end)
+                m_begin = m_end = 0;
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            clear_error(ec);
+            std::size_t done = take(buf);
+
+            while (done < buf.size())
+            {
+                auto rest = buf.subspan(done);
+                if (rest.size() >= m_buffer.size() && impl::is_aligned(rest.data(), m_align))
+                { // nothing left to batch, read whole alignment units directly into the caller's buffer
+                    auto got = device_read(rest.first(rest.size() - rest.size() % m_align), ec);
+                    done += got;
+                    if (got == 0 || has_error(ec))
+                        break;
+                    continue;
+                }
+
+                auto got = device_read(mutable_buffer(m_buffer), ec);
+                m_end = got;
+                done += take(rest);
+                if (got == 0 || has_error(ec))
+                    break;
+            }
+            return buf.first(done);
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const
+            requires sequence<Device>
+        { // sequence
+            return io::offset(m_device, ec) - buffered();
+        }
+
+        long_size_t seek_forward(long_size_t off, error_code_ptr ec = {})
+            requires forward<Device>
+        { // forward
+            auto cur = offset(ec);
+            if (has_error(ec))
+                return cur;
+            if (off >= cur && off - cur <= buffered())
+            {
+                consume(std::size_t(off - cur));
+                return off;
+            }
+            m_begin = m_end = 0;
+            if (m_align > 1 && off % m_align != 0)
+            {
+                io::seek_forward(m_device, off - off % m_align, ec);
+                return has_error(ec) ? offset() : fill_to(off, ec);
+            }
+            return io::seek_forward(m_device, off, ec);
+        }
+
+        long_size_t seek(long_size_t off, error_code_ptr ec = {})
+            requires random<Device>
+        { // random
+            auto dev_off = io::offset(m_device, ec);
+            if (has_error(ec))
+                return dev_off - buffered();
+
+            // the whole buffer, including consumed bytes, mirrors [dev_off - m_end, dev_off)
+            if (off <= dev_off && dev_off - off <= m_end)
+            {
+                m_begin = m_end - std::size_t(dev_off - off);
+                return off;
+            }
+            m_begin = m_end = 0;
+            if (m_align > 1 && off % m_align != 0)
+            {
+                io::seek(m_device, off - off % m_align, ec);
+                return has_error(ec) ? offset() : fill_to(off, ec);
+            }
+            return io::seek(m_device, off, ec);
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+            requires is_eofer<Device>
+        { // is_eofer
+            if (buffered() != 0)
+            {
+                clear_error(ec);
+                return false;
+            }
+            return io::is_eof(m_device, ec);
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // sizer
+            return io::size(m_device, ec);
+        }
+
+    private:
+        std::size_t device_read(mutable_buffer buf, error_code_ptr ec)
+        {
+            if constexpr (sequence<Device>)
+            {
+                // only a short read at the end of device leaves it at an unaligned offset,
+                // a direct read there would fail rather than report the end
+                if (m_align > 1)
+                {
+                    auto off = io::offset(m_device, ec);
+                    if (has_error(ec) || off % m_align != 0)
+                        return 0;
+                }
+            }
+            return io::read(m_device, buf, ec).size();
+        }
+
+        // the device is at the aligned offset before off: read a block and consume up to off
+        long_size_t fill_to(long_size_t off, error_code_ptr ec)
+        {
+            auto skip = std::size_t(off % m_align);
+            m_end = device_read(mutable_buffer(m_buffer), ec);
+            m_begin = std::min(skip, m_end);
+            return off - skip + m_begin;
+        }
+
+        std::size_t take(mutable_buffer buf) noexcept
+        {
+            auto n = std::min(buf.size(), buffered());
+            if (n != 0)
+                std::memcpy(buf.data(), m_buffer.data() + m_begin, n);
+            consume(n);
+            return n;
+        }
+    };
+
+    // Gather small writes into one block sized write of the underlying device.
+    // Writes of a block or more pass straight through once the pending data is flushed.
+    // Pending data is flushed by flush, sync, seek, truncate and on destruction, where errors are dropped.
+    // On devices requiring an alignment (direct io) the device only sees whole aligned blocks from
+    // aligned memory. flush writes an unaligned tail padded to a block, cuts the device back to
+    // its real size and keeps the tail buffered, the device at the block start, so later writes
+    // rewrite that block; seek to an unaligned offset reads back the bytes before it in its block.
+    // imp [ sequence, forward, random ] [ writer, syncer, truncater, sizer ]
+    template <writer Device>
+    class buffered_writer
+    {
+        Device &m_device;
+        std::size_t m_align;
+        impl::block_buffer m_buffer;
+        std::size_t m_size{0}; // data in m_buffer, to be written at the device offset
+        bool m_clean{false};   // m_buffer holds a tail already on the device
+
+    public:
+        explicit buffered_writer(Device &d, std::size_t block_size = default_block_size)
+            : m_device(d), m_align(std::max<std::size_t>(io::get_option<alignment_option>(d), 1)),
+              m_buffer(impl::round_up(std::max<std::size_t>(block_size, 1), m_align),
+                       aligned_allocator<std::byte>(m_align))
+        {
+        }
+
+        buffered_writer(const buffered_writer &) = delete;
+        buffered_writer &operator=(const buffered_writer &) = delete;
+
+        ~buffered_writer()
+        {
+            error_code ec;
+            flush(error_code_ptr(&ec));
+        }
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+        const Device &underlying() const noexcept
+        {
+            return m_device;
+        }
+
+        std::size_t block_size() const noexcept { return m_buffer.size(); }
+        std::size_t get_option(block_size_option) const noexcept { return block_size(); }
+
+        // size of the data written to the adaptor but not to the device yet
+        std::size_t pending() const noexcept { return m_clean ? 0 : m_size; }
+
+        void flush(error_code_ptr ec = {})
+        {
+            clear_error(ec);
+            flush_blocks(ec);
+            if (m_size == 0 || m_clean || m_size >= m_align || has_error(ec))
+                return;
+            flush_tail(ec);
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            clear_error(ec);
+            while (buf.size() > m_buffer.size() - m_size)
+            {
+                if (m_size == 0 && buf.size() >= m_buffer.size() && impl::is_aligned(buf.data(), m_align))
+                { // write whole alignment units straight through
+                    auto n = buf.size() - buf.size() % m_align;
+                    auto rest = io::write(m_device, buf.first(n), ec);
+                    buf = buf.subspan(n - rest.size());
+                    if (!rest.empty() || has_error(ec))
+                        return buf;
+                    continue;
+                }
+                if (m_size >= m_align)
+                {
+                    auto before = m_size;
+                    flush_blocks(ec);
+                    if (m_size == before || has_error(ec))
+                        return buf;
+                    continue;
+                }
+                // less than an alignment unit pending: top up the block, flushed on the next round
+                auto n = m_buffer.size() - m_size;
+                std::memcpy(m_buffer.data() + m_size, buf.data(), n);
+                m_size += n;
+                m_clean = false;
+                buf = buf.subspan(n);
+            }
+            if (!buf.empty())
+            {
+                std::memcpy(m_buffer.data() + m_size, buf.data(), buf.size());
+                m_clean = false;
+            }
+            m_size += buf.size();
+            return buf.last(0);
+        }
+
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            flush(ec);
+            if constexpr (syncer<Device>)
+            {
+                if (!has_error(ec))
+                    io::sync(m_device, ec);
+            }
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const
+            requires sequence<Device>
+        { // sequence
+            return io::offset(m_device, ec) + m_size;
+        }
+
+        long_size_t seek_forward(long_size_t off, error_code_ptr ec = {})
+            requires forward<Device>
+        { // forward
+            flush(ec);
+            if (has_error(ec))
+                return offset_after_error();
+            return io::seek_forward(m_device, off, ec);
+        }
+
+        long_size_t seek(long_size_t off, error_code_ptr ec = {})
+            requires random<Device>
+        { // random
+            flush(ec);
+            if (has_error(ec))
+                return offset_after_error();
+            if (m_align == 1)
+                return io::seek(m_device, off, ec);
+
+            m_size = 0;
+            m_clean = false;
+            auto base = off - off % m_align;
+            io::seek(m_device, base, ec);
+            if (has_error(ec))
+                return offset_after_error();
+            if (base == off)
+                return off;
+            // the head of the block is rewritten with the next block write, read it back
+            if constexpr (positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_reader))
+                {
+                    auto got = io::read_at(m_device, base, mutable_buffer(m_buffer.data(), m_align), ec);
+                    if (has_error(ec))
+                        return base;
+                    std::memset(m_buffer.data() + got.size(), 0, m_align - got.size());
+                    m_size = std::size_t(off - base);
+                    m_clean = true;
+                    return off;
+                }
+            }
+            set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+            return base;
+        }
+
+        long_size_t truncate(long_size_t size, error_code_ptr ec = {})
+            requires truncater<Device>
+        { // truncater
+            flush(ec);
+            if (has_error(ec))
+                return {};
+            return io::truncate(m_device, size, ec);
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+            requires sizer<Device> && sequence<Device>
+        { // sizer, pending data may extend the device
+            auto s = io::size(m_device, ec);
+            if (m_size == 0 || has_error(ec))
+                return s;
+            return std::max(s, io::offset(m_device, ec) + m_size);
+        }
+
+    private:
+        // the offset reported along with an error already in ec, which must neither be cleared
+        // nor turn into an exception: 0 when the device cannot tell it either
+        long_size_t offset_after_error() const noexcept
+        {
+            error_code e;
+            auto off = io::offset(m_device, error_code_ptr(&e));
+            return e ? 0 : off + m_size;
+        }
+
+        // write the whole alignment units of m_buffer, all of it when no alignment is required
+        void flush_blocks(error_code_ptr ec)
+        {
+            auto n = m_size - m_size % m_align;
+            if (n == 0)
+                return;
+            auto rest = io::write(m_device, const_buffer(m_buffer.data(), n), ec);
+            auto written = n - rest.size();
+            if (written != 0)
+            {
+                std::memmove(m_buffer.data(), m_buffer.data() + written, m_size - written);
+                m_size -= written;
+            }
+        }
+
+        // write a tail shorter than an alignment unit: padded to a whole unit, then the device is
+        // truncated back to its real size and returned to the start of the unit
+        void flush_tail(error_code_ptr ec)
+        {
+            if constexpr (random<Device> && sizer<Device> && truncater<Device> && positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::random | device_caps::sizer | device_caps::truncater |
+                                               device_caps::positional_reader))
+                {
+                    auto pos = io::offset(m_device, ec);
+                    if (has_error(ec))
+                        return;
+                    auto old_size = io::size(m_device, ec);
+                    if (has_error(ec))
+                        return;
+                    auto end = pos + m_size;
+                    if (old_size > end)
+                    { // keep the device bytes following the tail in its unit
+                        impl::block_buffer unit(m_align, aligned_allocator<std::byte>(m_align));
+                        auto got = io::read_at(m_device, pos, mutable_buffer(unit), ec);
+                        if (has_error(ec))
+                            return;
+                        if (got.size() > m_size)
+                            std::memcpy(m_buffer.data() + m_size, unit.data() + m_size, got.size() - m_size);
+                        std::memset(m_buffer.data() + std::max(m_size, got.size()), 0,
+                                    m_align - std::max(m_size, got.size()));
+                    }
+                    else
+                        std::memset(m_buffer.data() + m_size, 0, m_align - m_size);
+
+                    auto rest = io::write(m_device, const_buffer(m_buffer.data(), m_align), ec);
+                    if (has_error(ec))
+                        return;
+                    if (!rest.empty())
+                    {
+                        set_error_or_throw<io_exception>(ec, std::errc::io_error);
+                        return;
+                    }
+                    if (pos + m_align > std::max(old_size, end))
+                    {
+                        io::truncate(m_device, std::max(old_size, end), ec);
+                        if (has_error(ec))
+                            return;
+                    }
+                    io::seek(m_device, pos, ec);
+                    if (!has_error(ec))
+                        m_clean = true;
+                    return;
+                }
+            }
+            set_error_or_throw<io_exception>(ec, std::errc::function_not_supported);
+        }
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_BUFFERED_H
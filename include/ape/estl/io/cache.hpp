@@ -0,0 +1,381 @@
+#pragma once
+#ifndef APE_ESTL_IO_CACHE_H
+#define APE_ESTL_IO_CACHE_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    struct cache_stats
+    {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t evictions{0};
+    };
+
+    // read view pinning the memory it refers to, a cached block or a private copy
+    class pinned_rd_view
+    {
+    public:
+        pinned_rd_view() noexcept = default;
+        pinned_rd_view(std::shared_ptr<const void> owner, const_buffer data) noexcept
+            : m_owner(std::move(owner)), m_data(data) {}
+
+        const_buffer address() const noexcept { return m_data; }
+
+    private:
+        std::shared_ptr<const void> m_owner;
+        const_buffer m_data;
+    };
+
+    // Read cache of fixed size, block aligned ranges of a random access device.
+    // Blocks live in bounded LRU lists, sharded by block index, each shard with its own lock,
+    // so read_at/view_rd can be called from many threads. No more than capacity bytes of blocks are
+    // cached, one block at least: a capacity of fewer blocks than shard_count uses fewer shards.
+    // Views of a range inside one block pin the block instead of copying it, the pinned memory
+    // outlives eviction.
+    // The underlying device must not be modified behind the cache, see invalidate.
+    // imp [ sequence, forward, random ] [ reader, positional_reader, is_eofer, sizer, read_map ] [ advisor ]
+    template <typename Device>
+        requires random<Device> && reader<Device>
+    class block_cache_device
+    {
+        struct block
+        {
+            long_size_t index;
+            std::size_t size; // valid bytes, less than block size at the end of device
+            std::unique_ptr<std::byte[]> data;
+        };
+        using block_ptr = std::shared_ptr<const block>;
+
+        struct shard
+        {
+            std::mutex mutex;
+            std::list<block_ptr> lru; // most recently used first
+            std::unordered_map<long_size_t, typename std::list<block_ptr>::iterator> index;
+            std::atomic<std::uint64_t> hits{0}, misses{0}, evictions{0};
+        };
+
+    public:
+        static constexpr std::size_t default_cache_block_size = 64 * 1024;
+        static constexpr std::size_t default_shard_count = 16;
+        static constexpr std::size_t prefetch_divisor = 4; // willneed loads up to capacity / 4
+
+        block_cache_device(Device &d, std::size_t capacity, std::size_t block_size = default_cache_block_size,
+                           std::size_t shard_count = default_shard_count)
+            : m_device(d),
+              m_block_size(std::max<std::size_t>(block_size, 1)),
+              m_shard_count(std::clamp<std::size_t>(capacity / m_block_size, 1, std::max<std::size_t>(shard_count, 1))),
+              m_shards(new shard[m_shard_count])
+        {
+            m_shard_capacity = std::max<std::size_t>(capacity / m_block_size / m_shard_count, 1);
+        }
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+        const Device &underlying() const noexcept
+        {
+            return m_device;
+        }
+
+        std::size_t block_size() const noexcept { return m_block_size; }
+        std::size_t get_option(block_size_option) const noexcept { return m_block_size; }
+
+        cache_stats stats() const noexcept
+        {
+            cache_stats res;
+            for (std::size_t i = 0; i < m_shard_count; ++i)
+            {
+                res.hits += m_shards[i].hits.load(std::memory_order_relaxed);
+                res.misses += m_shards[i].misses.load(std::memory_order_relaxed);
+                res.evictions += m_shards[i].evictions.load(std::memory_order_relaxed);
+            }
+            return res;
+        }
+
+        // drop every cached block, pinned views keep their memory
+        void invalidate()
+        {
+            for (std::size_t i = 0; i < m_shard_count; ++i)
+            {
+                std::lock_guard lock(m_shards[i].mutex);
+                m_shards[i].index.clear();
+                m_shards[i].lru.clear();
+            }
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        long_size_t seek(long_size_t offset, error_code_ptr ec = {}) noexcept
+        { // random
+            clear_error(ec);
+            return m_pos = offset;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // sizer
+            return io::size(m_device, ec);
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // is_eofer
+            auto s = io::size(m_device, ec);
+            return has_error(ec) || m_pos >= s;
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            auto res = read_at(m_pos, buf, ec);
+            m_pos += res.size();
+            return res;
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+        { // positional_reader
+            std::size_t done = 0;
+            while (done < buf.size())
+            {
+                auto pos = off + done;
+                auto b = get_block(pos / m_block_size, ec);
+                if (has_error(ec))
+                    return buf.first(done);
+
+                auto first = std::size_t(pos % m_block_size);
+                if (first >= b->size)
+                    break;
+                auto n = std::min(b->size - first, buf.size() - done);
+                std::memcpy(buf.data() + done, b->data.get() + first, n);
+                done += n;
+            }
+            clear_error(ec);
+            return buf.first(done);
+        }
+
+        pinned_rd_view view_rd(long_offset_range h, error_code_ptr ec = {})
+            requires sizer<Device>
+        { // read_map
+            APE_Expects(is_valid_range(h));
+
+            // the device size is only queried when the cached blocks cannot tell the end of device
+            long_size_t dev_size = unknown_size;
+            if (h.end == unknown_offset)
+            {
+                dev_size = io::size(m_device, ec);
+                if (has_error(ec))
+                    return {};
+                h.end = long_offset_t(dev_size);
+            }
+
+            auto first_block = long_size_t(h.begin) / m_block_size;
+            if (h.end > h.begin && (long_size_t(h.end) - 1) / m_block_size == first_block)
+            {
+                // a block holds less than block size only at the end of device
+                auto b = get_block(first_block, ec);
+                if (has_error(ec))
+                    return {};
+                auto first = std::size_t(long_size_t(h.begin) % m_block_size);
+                auto n = std::size_t(ape::size(h));
+                if (first + n > b->size)
+                {
+                    set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                    return {};
+                }
+                return pinned_rd_view(b, {b->data.get() + first, n});
+            }
+
+            if (dev_size == unknown_size)
+            {
+                dev_size = io::size(m_device, ec);
+                if (has_error(ec))
+                    return {};
+            }
+            if (long_size_t(h.end) > dev_size || !in_size_t_range(ape::size(h)))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return {};
+            }
+
+            auto n = narrow_cast(ape::size(h));
+            auto copy = std::make_shared<std::vector<std::byte>>(n);
+            auto got = read_at(long_size_t(h.begin), *copy, ec);
+            return pinned_rd_view(copy, got);
+        }
+
+        // willneed loads the first blocks of rng, up to a quarter of the capacity, into free room only and
+        // behind the blocks in use: a hint never evicts the working set. dontneed drops the blocks of rng.
+        // The advice is passed on to the device.
+        void advise(long_offset_range rng, access_pattern pattern, error_code_ptr ec = {})
+        { // advisor
+            APE_Expects(is_valid_range(rng));
+            io::advise(m_device, rng, pattern, ec);
+            if (has_error(ec))
+                return;
+
+            auto first = long_size_t(rng.begin) / m_block_size;
+            auto last = rng.end == unknown_offset ? unknown_size : (long_size_t(rng.end) + m_block_size - 1) / m_block_size;
+            if (pattern == access_pattern::dontneed)
+            {
+                // cached blocks are fewer than those of a large range, walk them
+                for (std::size_t i = 0; i < m_shard_count; ++i)
+                {
+                    auto &s = m_shards[i];
+                    std::lock_guard lock(s.mutex);
+                    for (auto it = s.lru.begin(); it != s.lru.end();)
+                    {
+                        if ((*it)->index >= first && (*it)->index < last)
+                        {
+                            s.index.erase((*it)->index);
+                            it = s.lru.erase(it);
+                        }
+                        else
+                            ++it;
+                    }
+                }
+            }
+            else if (pattern == access_pattern::willneed)
+            {
+                auto budget = std::max<std::size_t>(m_shard_capacity * m_shard_count / prefetch_divisor, 1);
+                last = std::min(last, first + budget);
+                for (auto idx = first; idx < last; ++idx)
+                {
+                    if (!prefetch_block(idx, ec))
+                        return; // end of device or error
+                }
+            }
+        }
+
+    private:
+        block_ptr get_block(long_size_t index, error_code_ptr ec)
+        {
+            auto &s = m_shards[index % m_shard_count];
+            {
+                std::lock_guard lock(s.mutex);
+                if (auto it = s.index.find(index); it != s.index.end())
+                {
+                    s.lru.splice(s.lru.begin(), s.lru, it->second);
+                    s.hits.fetch_add(1, std::memory_order_relaxed);
+                    clear_error(ec);
+                    return *it->second;
+                }
+            }
+            s.misses.fetch_add(1, std::memory_order_relaxed);
+
+            // load without holding the shard lock, a concurrent miss on the same block loads it twice
+            auto b = load_block(index, ec);
+            if (has_error(ec))
+                return {};
+
+            std::lock_guard lock(s.mutex);
+            if (auto it = s.index.find(index); it != s.index.end())
+                return *it->second;
+
+            s.lru.push_front(b);
+            s.index.emplace(index, s.lru.begin());
+            while (s.lru.size() > m_shard_capacity)
+            {
+                s.index.erase(s.lru.back()->index);
+                s.lru.pop_back();
+                s.evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+            return b;
+        }
+
+        // load a block missing from a shard with free room, as the least recently used one.
+        // False at the end of device or on error.
+        bool prefetch_block(long_size_t index, error_code_ptr ec)
+        {
+            auto &s = m_shards[index % m_shard_count];
+            {
+                std::lock_guard lock(s.mutex);
+                if (auto it = s.index.find(index); it != s.index.end())
+                {
+                    clear_error(ec);
+                    return (*it->second)->size == m_block_size;
+                }
+                if (s.lru.size() >= m_shard_capacity)
+                {
+                    clear_error(ec);
+                    return true;
+                }
+            }
+            s.misses.fetch_add(1, std::memory_order_relaxed);
+
+            auto b = load_block(index, ec);
+            if (has_error(ec))
+                return false;
+
+            std::lock_guard lock(s.mutex);
+            if (!s.index.contains(index) && s.lru.size() < m_shard_capacity)
+            {
+                s.lru.push_back(b);
+                s.index.emplace(index, std::prev(s.lru.end()));
+            }
+            return b->size == m_block_size;
+        }
+
+        block_ptr load_block(long_size_t index, error_code_ptr ec)
+        {
+            auto b = std::make_shared<block>(block{index, 0, std::make_unique_for_overwrite<std::byte[]>(m_block_size)});
+            b->size = load(index * m_block_size, {b->data.get(), m_block_size}, ec);
+            return b;
+        }
+
+        std::size_t load(long_size_t off, mutable_buffer buf, error_code_ptr ec)
+        {
+            std::size_t done = 0;
+            if constexpr (positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_reader))
+                {
+                    while (done < buf.size())
+                    {
+                        auto n = io::read_at(m_device, off + done, buf.subspan(done), ec).size();
+                        if (n == 0 || has_error(ec))
+                            break;
+                        done += n;
+                    }
+                    return done;
+                }
+            }
+
+            std::lock_guard lock(m_device_mutex);
+            io::seek(m_device, off, ec);
+            while (done < buf.size() && !has_error(ec))
+            {
+                auto n = io::read(m_device, buf.subspan(done), ec).size();
+                if (n == 0)
+                    break;
+                done += n;
+            }
+            return done;
+        }
+
+        Device &m_device;
+        std::size_t m_block_size;
+        std::size_t m_shard_count;
+        std::size_t m_shard_capacity{1}; // blocks per shard
+        std::unique_ptr<shard[]> m_shards;
+        std::mutex m_device_mutex; // serializes seek + read on devices without positional io
+        long_size_t m_pos{0};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_CACHE_H
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef APE_ESTL_IO_DIRECT_FILE_H
+#define APE_ESTL_IO_DIRECT_FILE_H
+#include <ape/estl/io/file.hpp>
+#include <ape/estl/memory.hpp>
+#include <algorithm>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    namespace impl
+    {
+        // alignment of buffer addresses, offsets and lengths for direct io on fd: reported by statx
+        // where the kernel supports it, otherwise the file system block size, a multiple of it
+        inline std::size_t direct_io_alignment(int fd) noexcept
+        {
+#if defined(STATX_DIOALIGN)
+            struct ::statx stx;
+            if (::statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 && (stx.stx_mask & STATX_DIOALIGN) &&
+                stx.stx_dio_offset_align != 0)
+                return std::max<std::size_t>(stx.stx_dio_mem_align, stx.stx_dio_offset_align);
+#endif
+#if defined(O_DIRECT)
+            struct ::stat st;
+            if (::fstat(fd, &st) == 0 && st.st_blksize > 0)
+                return std::size_t(st.st_blksize);
+            return aligned_allocator<std::byte>::default_alignment;
+#else
+            unused(fd);
+            return 1; // F_NOCACHE has no alignment requirement
+#endif
+        }
+    }
+
+    // File bypassing the page cache (open_mode::direct).
+    // Transfers must use buffers, offsets and lengths aligned to get_option(alignment_option),
+    // the kernel rejects others with EINVAL; a read may still end short at the end of file.
+    // Allocate buffers with allocator(), and wrap the device in buffered_reader/buffered_writer
+    // for arbitrary transfers: they do whole aligned blocks and bounce unaligned tails.
+    // imp [ sequence, forward, random ]
+    //     [ reader, vec_reader, positional_reader, is_eofer, sizer ]
+    //     [ writer, vec_writer, positional_writer, syncer, truncater ]
+    //     [ advisor ]
+    class direct_file_device : public file_device
+    {
+    public:
+        direct_file_device() noexcept = default;
+
+        direct_file_device(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            open(path, mode, ec);
+        }
+        direct_file_device(const std::string &path, open_mode mode, error_code_ptr ec = {})
+            : direct_file_device(path.c_str(), mode, ec) {}
+
+        void open(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            file_device::open(path, mode | open_mode::direct, ec);
+            m_alignment = is_open() ? impl::direct_io_alignment(native_handle()) : 1;
+        }
+
+        std::size_t alignment() const noexcept { return m_alignment; }
+
+        using file_device::get_option;
+        std::size_t get_option(alignment_option) const noexcept { return m_alignment; }
+        std::size_t get_option(block_size_option) const noexcept
+        {
+            auto n = file_device::get_option(block_size_option{});
+            return (n + m_alignment - 1) / m_alignment * m_alignment;
+        }
+
+        // allocator of memory suitably aligned for this device
+        aligned_allocator<std::byte> allocator() const noexcept
+        {
+            return aligned_allocator<std::byte>(m_alignment);
+        }
+
+    private:
+        std::size_t m_alignment{1};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_DIRECT_FILE_H
@@ -0,0 +1,520 @@
+#pragma once
+#ifndef APE_ESTL_IO_FILE_H
+#define APE_ESTL_IO_FILE_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    enum class open_mode : unsigned
+    {
+        read = 1u << 0,
+        write = 1u << 1,
+        read_write = read | write,
+        create = 1u << 2,
+        truncate = 1u << 3,
+        exclusive = 1u << 4,
+        direct = 1u << 5, // bypass the page cache: O_DIRECT, F_NOCACHE on Apple systems
+    };
+
+    inline constexpr open_mode operator|(open_mode lhs, open_mode rhs) noexcept
+    {
+        return open_mode(unsigned(lhs) | unsigned(rhs));
+    }
+    inline constexpr open_mode operator&(open_mode lhs, open_mode rhs) noexcept
+    {
+        return open_mode(unsigned(lhs) & unsigned(rhs));
+    }
+    inline constexpr bool has_mode(open_mode mode, open_mode flag) noexcept
+    {
+        return (mode & flag) == flag;
+    }
+
+    namespace impl
+    {
+        inline error_code last_system_error() noexcept
+        {
+            return error_code(errno, std::system_category());
+        }
+
+        inline int to_posix_flags(open_mode mode) noexcept
+        {
+            int flags = 0;
+            if (has_mode(mode, open_mode::read_write))
+                flags = O_RDWR;
+            else if (has_mode(mode, open_mode::write))
+                flags = O_WRONLY;
+            else
+                flags = O_RDONLY;
+
+            if (has_mode(mode, open_mode::create))
+                flags |= O_CREAT;
+            if (has_mode(mode, open_mode::truncate))
+                flags |= O_TRUNC;
+            if (has_mode(mode, open_mode::exclusive))
+                flags |= O_EXCL;
+#if defined(O_DIRECT)
+            if (has_mode(mode, open_mode::direct))
+                flags |= O_DIRECT;
+#endif
+            return flags | O_CLOEXEC;
+        }
+
+        inline bool in_off_t_range(long_size_t n) noexcept
+        {
+            return n <= long_size_t(std::numeric_limits<off_t>::max());
+        }
+
+        // Drive a preadv/pwritev like call over bufs until all are transferred, the call returns 0 or fails.
+        // At most max_iovecs buffers are passed per call, partial transfers resume in the middle of a buffer.
+        template <typename Buffer, typename Op>
+        std::size_t transfer_vec(std::span<const Buffer> bufs, Op &&op, error_code_ptr ec)
+        {
+            constexpr std::size_t max_iovecs = 64;
+            ::iovec iov[max_iovecs];
+
+            std::size_t done = 0;
+            std::size_t idx = 0, skip = 0;
+            while (idx < bufs.size())
+            {
+                int count = 0;
+                for (auto i = idx; i < bufs.size() && std::size_t(count) < max_iovecs; ++i)
+                {
+                    auto b = i == idx ? bufs[i].subspan(skip) : bufs[i];
+                    iov[count++] = {const_cast<std::byte *>(b.data()), b.size()};
+                }
+
+                auto n = op(iov, count, done);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    set_error_or_throw<io_exception>(ec, last_system_error());
+                    return done;
+                }
+                if (n == 0)
+                    break;
+
+                done += std::size_t(n);
+                for (auto left = std::size_t(n); idx < bufs.size();)
+                {
+                    auto rest = bufs[idx].size() - skip;
+                    if (left < rest)
+                    {
+                        skip += left;
+                        break;
+                    }
+                    left -= rest;
+                    ++idx;
+                    skip = 0;
+                }
+            }
+            clear_error(ec);
+            return done;
+        }
+    }
+
+    // POSIX file descriptor device.
+    // The current position is kept in user space, all transfers are positional (pread/pwrite),
+    // so neither read, write nor seek pays for an lseek.
+    // imp [ sequence, forward, random ]
+    //     [ reader, vec_reader, positional_reader, is_eofer, sizer ]
+    //     [ writer, vec_writer, positional_writer, syncer, truncater ]
+    //     [ advisor, extent_finder, hole_puncher ]
+    class file_device
+    {
+    public:
+        constexpr file_device() noexcept = default;
+
+        explicit file_device(int fd, bool owned = true) noexcept
+            : m_fd(fd), m_owned(owned) {}
+
+        file_device(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            open(path, mode, ec);
+        }
+        file_device(const std::string &path, open_mode mode, error_code_ptr ec = {})
+            : file_device(path.c_str(), mode, ec) {}
+
+        file_device(file_device &&rhs) noexcept
+            : m_fd(std::exchange(rhs.m_fd, -1)), m_owned(rhs.m_owned), m_pos(std::exchange(rhs.m_pos, 0)) {}
+
+        file_device &operator=(file_device &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                close_();
+                m_fd = std::exchange(rhs.m_fd, -1);
+                m_owned = rhs.m_owned;
+                m_pos = std::exchange(rhs.m_pos, 0);
+            }
+            return *this;
+        }
+
+        file_device(const file_device &) = delete;
+        file_device &operator=(const file_device &) = delete;
+
+        ~file_device() { close_(); }
+
+        void open(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            close_();
+            m_pos = 0;
+            int fd;
+            do
+            {
+                fd = ::open(path, impl::to_posix_flags(mode), 0666);
+            } while (fd < 0 && errno == EINTR);
+
+            if (fd < 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+            if (has_mode(mode, open_mode::direct))
+                ::fcntl(fd, F_NOCACHE, 1);
+#endif
+            m_fd = fd;
+            m_owned = true;
+            clear_error(ec);
+        }
+
+        void close(error_code_ptr ec = {})
+        {
+            if (m_owned && m_fd >= 0 && ::close(std::exchange(m_fd, -1)) != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            m_fd = -1;
+            clear_error(ec);
+        }
+
+        bool is_open() const noexcept { return m_fd >= 0; }
+        int native_handle() const noexcept { return m_fd; }
+        using native_file_tag = void; // io::copy may copy_file_range into it
+
+        // st_blksize of the open file
+        std::size_t get_option(block_size_option) const noexcept
+        {
+            struct ::stat st;
+            if (m_fd < 0 || ::fstat(m_fd, &st) != 0 || st.st_blksize <= 0)
+                return block_size_option::default_value;
+            return std::size_t(st.st_blksize);
+        }
+        int release() noexcept { return std::exchange(m_fd, -1); }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+        { // is_eofer
+            auto s = size(ec);
+            return has_error(ec) || m_pos >= s;
+        }
+
+        long_size_t seek(long_size_t offset, error_code_ptr ec = {})
+        { // random
+            if (!impl::in_off_t_range(offset))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return m_pos;
+            }
+            clear_error(ec);
+            return m_pos = offset;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+        { // sizer
+            struct stat st;
+            if (::fstat(m_fd, &st) != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return {};
+            }
+            clear_error(ec);
+            return long_size_t(st.st_size);
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            auto n = do_read(m_pos, buf, ec);
+            m_pos += n;
+            return buf.first(n);
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            auto n = do_write(m_pos, buf, ec);
+            m_pos += n;
+            return buf.subspan(n);
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {}) const
+        { // positional_reader
+            return buf.first(do_read(off, buf, ec));
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            return buf.subspan(do_write(off, buf, ec));
+        }
+
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+        { // vec_reader
+            if (!impl::in_off_t_range(m_pos))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            auto n = impl::transfer_vec(bufs, [this](const ::iovec *iov, int count, std::size_t done)
+                                        { return ::preadv(m_fd, iov, count, off_t(m_pos + done)); },
+                                        ec);
+            m_pos += n;
+            return n;
+        }
+
+        std::size_t write_vec(const_buffers bufs, error_code_ptr ec = {})
+        { // vec_writer
+            if (!impl::in_off_t_range(m_pos))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            auto n = impl::transfer_vec(bufs, [this](const ::iovec *iov, int count, std::size_t done)
+                                        { return ::pwritev(m_fd, iov, count, off_t(m_pos + done)); },
+                                        ec);
+            m_pos += n;
+            return n;
+        }
+
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            if (::fsync(m_fd) != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            clear_error(ec);
+        }
+
+        long_size_t truncate(long_size_t size, error_code_ptr ec = {})
+        { // truncater
+            if (!impl::in_off_t_range(size))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            int r;
+            do
+            {
+                r = ::ftruncate(m_fd, off_t(size));
+            } while (r != 0 && errno == EINTR);
+
+            if (r != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return {};
+            }
+            clear_error(ec);
+            return size;
+        }
+
+        // posix_fadvise, a no-op where the system lacks it
+        void advise(long_offset_range rng, access_pattern pattern, error_code_ptr ec = {})
+        { // advisor
+            APE_Expects(is_valid_range(rng));
+#if defined(POSIX_FADV_NORMAL)
+            auto len = rng.end == unknown_offset ? long_size_t(0) : ape::size(rng);
+            if (!impl::in_off_t_range(long_size_t(rng.begin)) || !impl::in_off_t_range(len))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return;
+            }
+            int advice = POSIX_FADV_NORMAL;
+            switch (pattern)
+            {
+            case access_pattern::normal: advice = POSIX_FADV_NORMAL; break;
+            case access_pattern::sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+            case access_pattern::random: advice = POSIX_FADV_RANDOM; break;
+            case access_pattern::willneed: advice = POSIX_FADV_WILLNEED; break;
+            case access_pattern::dontneed: advice = POSIX_FADV_DONTNEED; break;
+            }
+            // returns the error instead of setting errno
+            if (auto r = ::posix_fadvise(m_fd, off_t(rng.begin), off_t(len), advice); r != 0)
+            {
+                set_error_or_throw<io_exception>(ec, error_code(r, std::system_category()));
+                return;
+            }
+#else
+            (void)pattern;
+#endif
+            clear_error(ec);
+        }
+
+        // lseek SEEK_DATA/SEEK_HOLE, moving the descriptor offset which transfers here do not use.
+        // Without them the whole file counts as data.
+        long_size_t find_data(long_size_t off, error_code_ptr ec = {}) const
+        { // extent_finder
+#if defined(SEEK_DATA)
+            return seek_extent(off, SEEK_DATA, ec);
+#else
+            auto fsize = size(ec);
+            return std::min(off, fsize);
+#endif
+        }
+
+        long_size_t find_hole(long_size_t off, error_code_ptr ec = {}) const
+        { // extent_finder
+#if defined(SEEK_HOLE)
+            return seek_extent(off, SEEK_HOLE, ec);
+#else
+            auto fsize = size(ec);
+            return std::max(off, fsize);
+#endif
+        }
+
+        // fallocate PUNCH_HOLE, function_not_supported where the system lacks it, the file
+        // system may report operation_not_supported
+        void punch_hole(long_offset_range rng, error_code_ptr ec = {})
+        { // hole_puncher
+            if (!is_valid_range(rng))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return;
+            }
+#if defined(FALLOC_FL_PUNCH_HOLE)
+            auto fsize = size(ec);
+            if (has_error(ec))
+                return;
+            auto end = std::min(long_size_t(rng.end), fsize);
+            if (long_size_t(rng.begin) >= end)
+            {
+                clear_error(ec);
+                return;
+            }
+            int r;
+            do
+            {
+                r = ::fallocate(m_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, off_t(rng.begin),
+                                off_t(end - long_size_t(rng.begin)));
+            } while (r != 0 && errno == EINTR);
+
+            if (r != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            clear_error(ec);
+#else
+            set_error_or_throw<io_exception>(ec, std::errc::function_not_supported);
+#endif
+        }
+
+    protected:
+        // read until buf is full, end of file or error, return the transferred bytes
+        std::size_t do_read(long_size_t pos, mutable_buffer buf, error_code_ptr ec) const
+        {
+            std::size_t done = 0;
+            while (done < buf.size())
+            {
+                if (!impl::in_off_t_range(pos + done))
+                {
+                    set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                    return done;
+                }
+                auto n = ::pread(m_fd, buf.data() + done, buf.size() - done, off_t(pos + done));
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                    return done;
+                }
+                if (n == 0)
+                    break;
+                done += std::size_t(n);
+            }
+            clear_error(ec);
+            return done;
+        }
+
+        // write until buf is consumed or error, return the transferred bytes
+        std::size_t do_write(long_size_t pos, const_buffer buf, error_code_ptr ec)
+        {
+            std::size_t done = 0;
+            while (done < buf.size())
+            {
+                if (!impl::in_off_t_range(pos + done))
+                {
+                    set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                    return done;
+                }
+                auto n = ::pwrite(m_fd, buf.data() + done, buf.size() - done, off_t(pos + done));
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                    return done;
+                }
+                done += std::size_t(n);
+            }
+            clear_error(ec);
+            return done;
+        }
+
+    private:
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+        long_size_t seek_extent(long_size_t off, int whence, error_code_ptr ec) const
+        {
+            if (!impl::in_off_t_range(off))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            auto r = ::lseek(m_fd, off_t(off), whence);
+            if (r < 0)
+            {
+                // off at or past the end, or no data after it
+                if (errno == ENXIO)
+                {
+                    auto fsize = size(ec);
+                    return whence == SEEK_DATA ? fsize : std::max(off, fsize);
+                }
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return {};
+            }
+            clear_error(ec);
+            return long_size_t(r);
+        }
+#endif
+
+        void close_() noexcept
+        {
+            if (m_owned && m_fd >= 0)
+                ::close(m_fd);
+            m_fd = -1;
+        }
+
+        int m_fd{-1};
+        bool m_owned{true};
+        long_size_t m_pos{0};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_FILE_H
@@ -2,11 +2,13 @@
 #ifndef APE_ESTL_IO_IOCORE_H
 #define APE_ESTL_IO_IOCORE_H
 #include <ape/config.hpp>
+#include <ape/estl/backports/expected.hpp>
 #include <ape/estl/backports/span.hpp>
 #include <ape/estl/error_code.hpp>
 #include <any>
 #include <cstddef>
 #include <limits>
+#include <type_traits>
 
 BEGIN_APE_NAMESPACE
 namespace io
@@ -29,9 +31,9 @@ namespace io
 
     // Interface List:
     // [ sequence, forward, random ]
-    // [ reader, is_eofer, sizer, read_map ]
-    // [ writer, syncer, truncater, write_map ]
-    // [ options ]
+    // [ reader, vec_reader, positional_reader, is_eofer, sizer, read_map ]
+    // [ writer, vec_writer, positional_writer, syncer, truncater, write_map ]
+    // [ options, advisor, extent_finder, hole_puncher ]
 
 
     // read && reader
@@ -78,6 +80,133 @@ namespace io
         } -> std::convertible_to<const_buffer>;
     };
 
+    // read_vec && vec_reader
+    using mutable_buffers = std::span<const mutable_buffer>;
+    using const_buffers = std::span<const const_buffer>;
+
+    template <typename Device>
+        requires requires(Device &&device, mutable_buffers bufs, error_code_ptr err) {
+            {
+                device.read_vec(bufs, err)
+            } -> std::convertible_to<std::size_t>;
+        }
+    decltype(auto) read_vec(Device &&device, mutable_buffers bufs, error_code_ptr err = {})
+    {
+        return device.read_vec(bufs, err);
+    }
+    // fallback: one read per buffer, stop at the first short read
+    template <reader Device>
+        requires(!requires(Device &&device, mutable_buffers bufs, error_code_ptr err) {
+            device.read_vec(bufs, err);
+        })
+    std::size_t read_vec(Device &&device, mutable_buffers bufs, error_code_ptr err = {})
+    {
+        clear_error(err);
+        std::size_t total = 0;
+        for (auto buf : bufs)
+        {
+            auto n = read(device, buf, err).size();
+            total += n;
+            if (n < buf.size() || has_error(err))
+                break;
+        }
+        return total;
+    }
+    // return: size of read in data, filled into bufs in order
+    template <typename Device>
+    concept vec_reader = requires(Device &&device, mutable_buffers bufs, error_code_ptr err) {
+        {
+            read_vec(device, bufs, err)
+        } -> std::convertible_to<std::size_t>;
+        {
+            read_vec(device, bufs)
+        } -> std::convertible_to<std::size_t>;
+    };
+
+    // write_vec && vec_writer
+    template <typename Device>
+        requires requires(Device &&device, const_buffers bufs, error_code_ptr err) {
+            {
+                device.write_vec(bufs, err)
+            } -> std::convertible_to<std::size_t>;
+        }
+    decltype(auto) write_vec(Device &&device, const_buffers bufs, error_code_ptr err = {})
+    {
+        return device.write_vec(bufs, err);
+    }
+    // fallback: one write per buffer, stop at the first short write
+    template <writer Device>
+        requires(!requires(Device &&device, const_buffers bufs, error_code_ptr err) {
+            device.write_vec(bufs, err);
+        })
+    std::size_t write_vec(Device &&device, const_buffers bufs, error_code_ptr err = {})
+    {
+        clear_error(err);
+        std::size_t total = 0;
+        for (auto buf : bufs)
+        {
+            auto rest = write(device, buf, err).size();
+            total += buf.size() - rest;
+            if (rest != 0 || has_error(err))
+                break;
+        }
+        return total;
+    }
+    // return: size of written data, taken from bufs in order
+    template <typename Device>
+    concept vec_writer = requires(Device &&device, const_buffers bufs, error_code_ptr err) {
+        {
+            write_vec(device, bufs, err)
+        } -> std::convertible_to<std::size_t>;
+        {
+            write_vec(device, bufs)
+        } -> std::convertible_to<std::size_t>;
+    };
+
+    // read_at && positional_reader
+    template <typename Device>
+        requires requires(Device &&device, long_size_t off, mutable_buffer buf, error_code_ptr err) {
+            {
+                device.read_at(off, buf, err)
+            } -> std::convertible_to<mutable_buffer>;
+        }
+    decltype(auto) read_at(Device &&device, long_size_t off, mutable_buffer buf, error_code_ptr err = {})
+    {
+        return device.read_at(off, buf, err);
+    }
+    // return: read in data, the device offset is untouched
+    template <typename Device>
+    concept positional_reader = requires(Device &&device, long_size_t off, mutable_buffer buf, error_code_ptr err) {
+        {
+            read_at(device, off, buf, err)
+        } -> std::convertible_to<mutable_buffer>;
+        {
+            read_at(device, off, buf)
+        } -> std::convertible_to<mutable_buffer>;
+    };
+
+    // write_at && positional_writer
+    template <typename Device>
+        requires requires(Device &&device, long_size_t off, const_buffer buf, error_code_ptr err) {
+            {
+                device.write_at(off, buf, err)
+            } -> std::convertible_to<const_buffer>;
+        }
+    decltype(auto) write_at(Device &&device, long_size_t off, const_buffer buf, error_code_ptr err = {})
+    {
+        return device.write_at(off, buf, err);
+    }
+    // return: not written data, the device offset is untouched
+    template <typename Device>
+    concept positional_writer = requires(Device &&device, long_size_t off, const_buffer buf, error_code_ptr err) {
+        {
+            write_at(device, off, buf, err)
+        } -> std::convertible_to<const_buffer>;
+        {
+            write_at(device, off, buf)
+        } -> std::convertible_to<const_buffer>;
+    };
+
     // sync && syncer
     template <typename Device>
         requires requires(Device &&device, error_code_ptr err) {
@@ -200,6 +329,9 @@ namespace io
 
     // seek_forward && forward
     template <random Device>
+        requires(!requires(Device &&device, long_size_t off, error_code_ptr err) {
+            device.seek_forward(off, err);
+        })
     decltype(auto) seek_forward(Device &&device, long_size_t off, error_code_ptr err = {})
     {
         return seek(device, off, err);
@@ -277,27 +409,7 @@ namespace io
         } -> read_view;
     } && sizer<Device>;
 
-    // write_view
-    template <typename Device>
-        requires requires(Device &&device) {
-            {
-                device.address()
-            } -> std::convertible_to<mutable_buffer>;
-        }
-    decltype(auto) address(Device &&device)
-    {
-        return device.address();
-    }
-    template <typename Device>
-        requires requires(Device &&device) {
-            {
-                device->address()
-            } -> std::convertible_to<mutable_buffer>;
-        }
-    decltype(auto) address(Device &&device)
-    {
-        return device->address();
-    }
+    // write_view, address() above also serves writable views as mutable_buffer converts to const_buffer
     template <typename Device>
     concept write_view = requires(Device &&device) {
         {
@@ -330,6 +442,150 @@ namespace io
         } -> write_view;
     } && sizer<Device>;
 
+    // advise && advisor
+    // Expected use of a range, a hint: devices may ignore it and the data read is never changed.
+    enum class access_pattern
+    {
+        normal,     // no particular order, undo earlier advice
+        sequential, // read in increasing offsets, read ahead aggressively
+        random,     // read ahead is wasted
+        willneed,   // will be read soon, fetch it now
+        dontneed,   // will not be read again soon, free the memory caching it
+    };
+
+    template <typename Device>
+        requires requires(Device &&device, long_offset_range rng, access_pattern pattern, error_code_ptr err) {
+            device.advise(rng, pattern, err);
+        }
+    void advise(Device &&device, long_offset_range rng, access_pattern pattern, error_code_ptr err = {})
+    {
+        device.advise(rng, pattern, err);
+    }
+    // the default is a no-op, any device may be advised
+    template <typename Device>
+        requires(!requires(Device &&device, long_offset_range rng, access_pattern pattern, error_code_ptr err) {
+            device.advise(rng, pattern, err);
+        })
+    void advise(Device &&, long_offset_range, access_pattern, error_code_ptr err = {}) noexcept
+    {
+        clear_error(err);
+    }
+    // devices acting on advice
+    template <typename Device>
+    concept advisor = requires(Device &&device, long_offset_range rng, access_pattern pattern, error_code_ptr err) {
+        device.advise(rng, pattern, err);
+        device.advise(rng, pattern);
+    };
+
+    // find_data, find_hole && extent_finder
+    // Sparse devices tell allocated extents from holes, which read as zeros, without reading.
+    // find_data returns the first offset at or after off holding data, size() when there is none;
+    // find_hole the first offset at or after off in a hole, size() counting as one.
+    template <typename Device>
+        requires requires(Device &&device, long_size_t off, error_code_ptr err) {
+            {
+                device.find_data(off, err)
+            } -> std::convertible_to<long_size_t>;
+        }
+    long_size_t find_data(Device &&device, long_size_t off, error_code_ptr err = {})
+    {
+        return device.find_data(off, err);
+    }
+    template <typename Device>
+        requires requires(Device &&device, long_size_t off, error_code_ptr err) {
+            {
+                device.find_hole(off, err)
+            } -> std::convertible_to<long_size_t>;
+        }
+    long_size_t find_hole(Device &&device, long_size_t off, error_code_ptr err = {})
+    {
+        return device.find_hole(off, err);
+    }
+    template <typename Device>
+    concept extent_finder = requires(Device &&device, long_size_t off, error_code_ptr err) {
+        {
+            find_data(device, off, err)
+        } -> std::convertible_to<long_size_t>;
+        {
+            find_hole(device, off, err)
+        } -> std::convertible_to<long_size_t>;
+        {
+            find_data(device, off)
+        } -> std::convertible_to<long_size_t>;
+        {
+            find_hole(device, off)
+        } -> std::convertible_to<long_size_t>;
+    } && sizer<Device>;
+
+    // punch_hole && hole_puncher
+    // Deallocate a range, which then reads as zeros. The size is kept, the range is clamped to it.
+    template <typename Device>
+        requires requires(Device &&device, long_offset_range rng, error_code_ptr err) {
+            device.punch_hole(rng, err);
+        }
+    void punch_hole(Device &&device, long_offset_range rng, error_code_ptr err = {})
+    {
+        device.punch_hole(rng, err);
+    }
+    template <typename Device>
+    concept hole_puncher = requires(Device &&device, long_offset_range rng, error_code_ptr err) {
+        punch_hole(device, rng, err);
+        punch_hole(device, rng);
+    };
+
+    // device_caps && supports
+    // The concepts a device models, as flags. Devices deciding at run time what they support model
+    // every concept and answer supports(device_caps), any_device does; generic code picking a path
+    // by concept asks io::supports before taking it. Other devices support what they model.
+    enum class device_caps : unsigned
+    {
+        none = 0,
+        sequence = 1u << 0,
+        random = 1u << 1,
+        reader = 1u << 2,
+        positional_reader = 1u << 3,
+        is_eofer = 1u << 4,
+        sizer = 1u << 5,
+        read_map = 1u << 6,
+        writer = 1u << 7,
+        positional_writer = 1u << 8,
+        syncer = 1u << 9,
+        truncater = 1u << 10,
+        write_map = 1u << 11,
+        vec_reader = 1u << 12,
+        vec_writer = 1u << 13,
+        options = 1u << 14,
+        advisor = 1u << 15,
+        extent_finder = 1u << 16,
+        hole_puncher = 1u << 17,
+    };
+
+    inline constexpr device_caps operator|(device_caps lhs, device_caps rhs) noexcept
+    {
+        return device_caps(unsigned(lhs) | unsigned(rhs));
+    }
+    inline constexpr device_caps operator&(device_caps lhs, device_caps rhs) noexcept
+    {
+        return device_caps(unsigned(lhs) & unsigned(rhs));
+    }
+    inline constexpr bool has_caps(device_caps caps, device_caps flag) noexcept
+    {
+        return (caps & flag) == flag;
+    }
+
+    template <typename Device>
+    bool supports(const Device &device, device_caps caps) noexcept
+    {
+        if constexpr (requires {
+                          {
+                              device.supports(caps)
+                          } -> std::convertible_to<bool>;
+                      })
+            return device.supports(caps);
+        else
+            return true;
+    }
+
     // options
     template <typename Device>
         requires requires(Device &&device, int id, const std::any &optdata, error_code_ptr err) {
@@ -368,6 +624,135 @@ namespace io
         } -> std::convertible_to<std::any>;
     };
 
+    // result returning variants
+    // try_xxx(device, ...) report errors in the returned value instead of through error_code_ptr or
+    // an exception. The error is read from a local error_code, so the success path costs one test.
+    // try_read/try_write report the bytes transferred before an error along with it, the buffer is
+    // the one the call would return: the bytes read, or those left unwritten to resume from.
+    template <typename T>
+    using result = stl::expected<T, error_code>;
+
+    template <typename Buffer>
+    struct transfer_error
+    {
+        Buffer value;
+        error_code error;
+    };
+
+    template <typename Buffer>
+    using transfer_result = stl::expected<Buffer, transfer_error<Buffer>>;
+
+    template <reader Device>
+    transfer_result<mutable_buffer> try_read(Device &&device, mutable_buffer buf)
+    {
+        error_code ec;
+        auto res = io::read(device, buf, error_code_ptr(&ec));
+        if (ec) [[unlikely]]
+            return stl::unexpected(transfer_error<mutable_buffer>{res, ec});
+        return res;
+    }
+
+    template <writer Device>
+    transfer_result<const_buffer> try_write(Device &&device, const_buffer buf)
+    {
+        error_code ec;
+        auto res = io::write(device, buf, error_code_ptr(&ec));
+        if (ec) [[unlikely]]
+            return stl::unexpected(transfer_error<const_buffer>{res, ec});
+        return res;
+    }
+
+    template <random Device>
+    result<long_size_t> try_seek(Device &&device, long_size_t off)
+    {
+        error_code ec;
+        auto res = io::seek(device, off, error_code_ptr(&ec));
+        if (ec) [[unlikely]]
+            return stl::unexpected(ec);
+        return res;
+    }
+
+    // typed options
+    // An option tag names its value type and the constexpr default reported by devices which
+    // do not support it. Devices support a tag with get_option(Tag)/set_option(Tag, value, err)
+    // members, resolved at compile time. A tag with an int id also reaches devices which only
+    // model options, through the std::any getopt/setopt slow path.
+    template <typename Tag>
+    concept option_tag = requires {
+        typename Tag::value_type;
+        {
+            Tag::default_value
+        } -> std::convertible_to<typename Tag::value_type>;
+    };
+
+    template <typename Tag>
+    concept any_option_tag = option_tag<Tag> && requires {
+        {
+            Tag::id
+        } -> std::convertible_to<int>;
+    };
+
+    // preferred transfer size, in bytes
+    struct block_size_option
+    {
+        using value_type = std::size_t;
+        static constexpr value_type default_value = 4096;
+        static constexpr int id = 1;
+    };
+
+    // alignment required of buffer addresses, offsets and lengths, in bytes
+    struct alignment_option
+    {
+        using value_type = std::size_t;
+        static constexpr value_type default_value = 1;
+        static constexpr int id = 2;
+    };
+
+    template <typename Device, typename Tag>
+    concept supports_option = option_tag<Tag> && requires(const Device &device) {
+        {
+            device.get_option(Tag{})
+        } -> std::convertible_to<typename Tag::value_type>;
+    };
+
+    template <option_tag Tag, typename Device>
+    constexpr typename Tag::value_type get_option(Device &&device)
+    {
+        if constexpr (supports_option<std::remove_cvref_t<Device>, Tag>)
+        {
+            return device.get_option(Tag{});
+        }
+        else if constexpr (any_option_tag<Tag> && options<Device>)
+        {
+            error_code ec;
+            std::any res = getopt(device, Tag::id, std::any{}, error_code_ptr(&ec));
+            if (auto p = std::any_cast<typename Tag::value_type>(&res); p && !ec)
+                return *p;
+            return Tag::default_value;
+        }
+        else
+        {
+            return Tag::default_value;
+        }
+    }
+
+    template <option_tag Tag, typename Device>
+    void set_option(Device &&device, const typename Tag::value_type &value, error_code_ptr err = {})
+    {
+        if constexpr (requires { device.set_option(Tag{}, value, err); })
+        {
+            device.set_option(Tag{}, value, err);
+        }
+        else if constexpr (any_option_tag<Tag> && options<Device>)
+        {
+            setopt(device, Tag::id, std::any{}, std::any(value), err);
+        }
+        else
+        {
+            set_error_or_throw<io_exception>(err, std::errc::function_not_supported);
+        }
+    }
+
 } // end namespace io;
 
 END_APE_NAMESPACE
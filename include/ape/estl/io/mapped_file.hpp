@@ -0,0 +1,386 @@
+#pragma once
+#ifndef APE_ESTL_IO_MAPPED_FILE_H
+#define APE_ESTL_IO_MAPPED_FILE_H
+#include <ape/estl/io/file.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <sys/mman.h>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    namespace impl
+    {
+        // one mmap of a file, unmapped when the last device or view referring to it goes away
+        class file_mapping
+        {
+        public:
+            file_mapping(std::byte *addr, std::size_t length) noexcept : m_addr(addr), m_length(length) {}
+            file_mapping(const file_mapping &) = delete;
+            file_mapping &operator=(const file_mapping &) = delete;
+            ~file_mapping()
+            {
+                ::munmap(m_addr, m_length);
+            }
+
+            std::byte *data() const noexcept { return m_addr; }
+            std::size_t capacity() const noexcept { return m_length; }
+
+        private:
+            std::byte *m_addr;
+            std::size_t m_length;
+        };
+
+        inline std::size_t page_size() noexcept
+        {
+            static const std::size_t s = std::size_t(::sysconf(_SC_PAGESIZE));
+            return s;
+        }
+
+        inline std::size_t round_up_to_page(std::size_t n) noexcept
+        {
+            auto p = page_size();
+            return (n + p - 1) / p * p;
+        }
+    }
+
+    class mapped_rd_view
+    {
+    public:
+        mapped_rd_view() noexcept = default;
+        mapped_rd_view(std::shared_ptr<const impl::file_mapping> m, const_buffer data) noexcept
+            : m_mapping(std::move(m)), m_data(data) {}
+
+        const_buffer address() const noexcept { return m_data; }
+
+    private:
+        std::shared_ptr<const impl::file_mapping> m_mapping;
+        const_buffer m_data;
+    };
+
+    class mapped_wr_view
+    {
+    public:
+        mapped_wr_view() noexcept = default;
+        mapped_wr_view(std::shared_ptr<impl::file_mapping> m, mutable_buffer data) noexcept
+            : m_mapping(std::move(m)), m_data(data) {}
+
+        mutable_buffer address() const noexcept { return m_data; }
+
+    private:
+        std::shared_ptr<impl::file_mapping> m_mapping;
+        mutable_buffer m_data;
+    };
+
+    // Memory mapped file.
+    // Views share the ownership of the mapped pages, so they remain valid after the device
+    // remaps (grows) the file or is destroyed. Writable mappings reserve address space
+    // geometrically, growing the file within the reservation only costs an ftruncate.
+    // imp [ sequence, forward, random ]
+    //     [ reader, positional_reader, is_eofer, sizer, read_map ]
+    //     [ writer, positional_writer, syncer, truncater, write_map ]
+    //     [ advisor ]
+    class mapped_file_device
+    {
+    public:
+        mapped_file_device() noexcept = default;
+
+        mapped_file_device(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            open(path, mode, ec);
+        }
+        mapped_file_device(const std::string &path, open_mode mode, error_code_ptr ec = {})
+            : mapped_file_device(path.c_str(), mode, ec) {}
+
+        mapped_file_device(mapped_file_device &&) noexcept = default;
+        mapped_file_device &operator=(mapped_file_device &&) noexcept = default;
+
+        void open(const char *path, open_mode mode, error_code_ptr ec = {})
+        {
+            // a shared writable mapping needs a descriptor opened for reading too
+            m_writable = has_mode(mode, open_mode::write);
+            if (m_writable)
+                mode = mode | open_mode::read;
+
+            m_mapping.reset();
+            m_size = m_pos = 0;
+            m_file.open(path, mode, ec);
+            if (has_error(ec))
+                return;
+
+            auto s = m_file.size(ec);
+            if (has_error(ec))
+                return;
+            if (!in_size_t_range(s))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return;
+            }
+            remap(narrow_cast(s), ec);
+        }
+
+        bool is_open() const noexcept { return m_file.is_open(); }
+        int native_handle() const noexcept { return m_file.native_handle(); }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const noexcept
+        { // is_eofer
+            clear_error(ec);
+            return m_pos >= m_size;
+        }
+
+        long_size_t seek(long_size_t offset, error_code_ptr ec = {})
+        { // random
+            if (!in_size_t_range(offset))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return m_pos;
+            }
+            clear_error(ec);
+            return m_pos = narrow_cast(offset);
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const noexcept
+        { // sizer
+            clear_error(ec);
+            return m_size;
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            clear_error(ec);
+            if (m_pos >= m_size)
+                return buf.first(0);
+
+            auto n = std::min(buf.size(), m_size - m_pos);
+            std::memcpy(buf.data(), m_mapping->data() + m_pos, n);
+            m_pos += n;
+            return buf.first(n);
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {}) const noexcept
+        { // positional_reader
+            clear_error(ec);
+            if (off >= m_size)
+                return buf.first(0);
+
+            auto n = std::min(buf.size(), std::size_t(m_size - off));
+            std::memcpy(buf.data(), m_mapping->data() + off, n);
+            return buf.first(n);
+        }
+
+        mapped_rd_view view_rd(long_offset_range h, error_code_ptr ec = {})
+        { // read_map
+            APE_Expects(is_valid_range(h));
+
+            if (h.end == unknown_offset)
+                h.end = long_offset_t(m_size);
+            if (long_size_t(h.end) > m_size)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return {};
+            }
+            clear_error(ec);
+            if (!m_mapping)
+                return {};
+            return mapped_rd_view(m_mapping, {m_mapping->data() + h.begin, m_mapping->data() + h.end});
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            if (!in_size_t_range(long_size_t(m_pos) + buf.size()))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return buf;
+            }
+            auto end = m_pos + buf.size();
+            if (!ensure_writable(end, ec))
+                return buf;
+            if (buf.empty() || !m_mapping)
+            {
+                clear_error(ec);
+                return buf;
+            }
+
+            std::memcpy(m_mapping->data() + m_pos, buf.data(), buf.size());
+            m_pos = end;
+            clear_error(ec);
+            return buf.last(0);
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            if (!in_size_t_range(off + buf.size()))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return buf;
+            }
+            auto end = narrow_cast(off + buf.size());
+            if (!ensure_writable(end, ec))
+                return buf;
+            if (buf.empty() || !m_mapping)
+            {
+                clear_error(ec);
+                return buf;
+            }
+
+            std::memcpy(m_mapping->data() + off, buf.data(), buf.size());
+            clear_error(ec);
+            return buf.last(0);
+        }
+
+        mapped_wr_view view_wr(long_offset_range h, error_code_ptr ec = {})
+        { // write_map
+            APE_Expects(is_valid_range(h));
+
+            if (h.end == unknown_offset)
+                h.end = long_offset_t(m_size);
+            if (!in_size_t_range(h.end))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            if (!ensure_writable(narrow_cast(long_size_t(h.end)), ec))
+                return {};
+
+            clear_error(ec);
+            if (!m_mapping)
+                return {};
+            return mapped_wr_view(m_mapping, {m_mapping->data() + h.begin, m_mapping->data() + h.end});
+        }
+
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            if (m_writable && m_mapping && m_size != 0 &&
+                ::msync(m_mapping->data(), m_size, MS_SYNC) != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            clear_error(ec);
+        }
+
+        // madvise on the mapped pages of rng. dontneed also advises the file: the pages leave the
+        // mapping, then clean ones the page cache. The mapping is shared, so no data is lost.
+        void advise(long_offset_range rng, access_pattern pattern, error_code_ptr ec = {})
+        { // advisor
+            APE_Expects(is_valid_range(rng));
+            auto end = rng.end == unknown_offset ? m_size : std::size_t(std::min<long_size_t>(long_size_t(rng.end), m_size));
+            if (!m_mapping || long_size_t(rng.begin) >= end)
+            {
+                clear_error(ec);
+                return;
+            }
+            // madvise wants a page aligned start
+            auto begin = std::size_t(rng.begin) / impl::page_size() * impl::page_size();
+            int advice = MADV_NORMAL;
+            switch (pattern)
+            {
+            case access_pattern::normal: advice = MADV_NORMAL; break;
+            case access_pattern::sequential: advice = MADV_SEQUENTIAL; break;
+            case access_pattern::random: advice = MADV_RANDOM; break;
+            case access_pattern::willneed: advice = MADV_WILLNEED; break;
+            case access_pattern::dontneed: advice = MADV_DONTNEED; break;
+            }
+            if (::madvise(m_mapping->data() + begin, end - begin, advice) != 0)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            if (pattern == access_pattern::dontneed)
+                m_file.advise(rng, pattern, ec); // page cache pages of the file
+            else
+                clear_error(ec);
+        }
+
+        long_size_t truncate(long_size_t size, error_code_ptr ec = {})
+        { // truncater
+            if (!m_writable)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::bad_file_descriptor);
+                return {};
+            }
+            if (!in_size_t_range(size))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return {};
+            }
+            auto new_size = narrow_cast(size);
+            m_file.truncate(new_size, ec);
+            if (has_error(ec))
+                return {};
+
+            if (!m_mapping || m_mapping->capacity() < new_size)
+                remap(new_size, ec);
+            else
+                m_size = new_size;
+            return has_error(ec) ? long_size_t{} : size;
+        }
+
+    private:
+        bool ensure_writable(std::size_t end, error_code_ptr ec)
+        {
+            if (!m_writable)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::bad_file_descriptor);
+                return false;
+            }
+            if (end <= m_size)
+                return true;
+
+            m_file.truncate(end, ec);
+            if (has_error(ec))
+                return false;
+            if (m_mapping && end <= m_mapping->capacity())
+            {
+                m_size = end;
+                return true;
+            }
+            remap(end, ec);
+            return !has_error(ec);
+        }
+
+        void remap(std::size_t new_size, error_code_ptr ec)
+        {
+            auto capacity = new_size;
+            if (m_writable && m_mapping)
+                capacity = std::max(capacity, m_mapping->capacity() * 2);
+            capacity = impl::round_up_to_page(capacity);
+
+            if (capacity == 0)
+            {
+                m_mapping.reset();
+                m_size = 0;
+                clear_error(ec);
+                return;
+            }
+
+            int prot = m_writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+            void *addr = ::mmap(nullptr, capacity, prot, MAP_SHARED, m_file.native_handle(), 0);
+            if (addr == MAP_FAILED)
+            {
+                set_error_or_throw<io_exception>(ec, impl::last_system_error());
+                return;
+            }
+            m_mapping = std::make_shared<impl::file_mapping>(static_cast<std::byte *>(addr), capacity);
+            m_size = new_size;
+            clear_error(ec);
+        }
+
+        file_device m_file;
+        std::shared_ptr<impl::file_mapping> m_mapping;
+        std::size_t m_size{0};
+        std::size_t m_pos{0};
+        bool m_writable{false};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_MAPPED_FILE_H
@@ -2,8 +2,12 @@
 #ifndef APE_ESTL_IO_MEMORY_H
 #define APE_ESTL_IO_MEMORY_H
 #include <ape/estl/io/iocore.hpp>
+#include <ape/estl/memory.hpp>
 #include <type_traits>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 
 BEGIN_APE_NAMESPACE
@@ -88,6 +92,40 @@ namespace io
             rep.data.resize(size);
         };
 
+    // represent whose storage can reserve capacity ahead of its size
+    template <typename Represent>
+    concept reservable_represent =
+        truncatable_represent<Represent> &&
+        (requires(std::remove_cvref_t<Represent> &rep, std::size_t size) {
+            rep.data().reserve(size);
+            { rep.data().capacity() } -> std::convertible_to<std::size_t>;
+        } ||
+         requires(std::remove_cvref_t<Represent> &rep, std::size_t size) {
+             rep.data.reserve(size);
+             { rep.data.capacity() } -> std::convertible_to<std::size_t>;
+         });
+
+    // growth policy of reservable represents, which may name their own as Represent::growth_policy
+    struct geometric_growth
+    {
+        static constexpr std::size_t next_capacity(std::size_t capacity, std::size_t required) noexcept
+        {
+            return std::max(required, capacity + capacity / 2);
+        }
+    };
+
+    template <typename Represent>
+    struct represent_growth_policy
+    {
+        using type = geometric_growth;
+    };
+    template <typename Represent>
+        requires requires { typename Represent::growth_policy; }
+    struct represent_growth_policy<Represent>
+    {
+        using type = typename Represent::growth_policy;
+    };
+
     template <read_represent_func Rep>
     decltype(auto) get_data_part(Rep &&rep) noexcept
     {
@@ -159,7 +197,7 @@ namespace io
             clear_error(ec);
 
             if (buf.empty() || get_is_eof(rep))
-                return buf;
+                return buf.first(0);
 
             auto n = std::min(get_readable_size(rep), buf.size());
             auto ditr = std::copy_n(get_pos_iter(rep), n, buf.begin());
@@ -168,6 +206,36 @@ namespace io
             return {buf.begin(), ditr};
         }
 
+        template <read_represent Represent>
+        mutable_buffer read_at(const Represent &rep, long_size_t off, mutable_buffer buf, error_code_ptr ec) noexcept
+        {
+            clear_error(ec);
+
+            auto size = get_size(rep);
+            if (buf.empty() || off >= size)
+                return buf.first(0);
+
+            auto first = get_data_part(rep).begin() + narrow_cast(off);
+            auto n = std::min(std::size_t(size - off), buf.size());
+            std::copy_n(first, n, buf.begin());
+            return buf.first(n);
+        }
+
+        template <read_represent Represent>
+        std::size_t read_vec(Represent &rep, mutable_buffers bufs, error_code_ptr ec) noexcept
+        {
+            clear_error(ec);
+
+            std::size_t total = 0;
+            for (auto buf : bufs)
+            {
+                if (get_is_eof(rep))
+                    break;
+                total += read(rep, buf, ec).size();
+            }
+            return total;
+        }
+
         template <read_represent Represent>
         long_size_t offset(const Represent &rep, error_code_ptr ec = {}) noexcept
         { // sequence
@@ -220,26 +288,66 @@ namespace io
                                    get_data_part(rep).begin() + narrow_cast(h.end)});
         }
 
+        // resize to new_size, only bytes from the old size up to zero_end are zero filled,
+        // bytes about to be overwritten are left uninitialized when the storage allows it
         template <write_represent Represent>
-        long_size_t do_truncate(Represent &rep, long_size_t size, error_code_ptr err)
+        long_size_t do_grow(Represent &rep, std::size_t new_size, std::size_t zero_end, error_code_ptr err)
         {
             if constexpr (!truncatable_represent<Represent>)
             {
                 set_error_or_throw<io_exception>(err, std::errc::function_not_supported);
                 return {};
             }
+            else
+            {
+                auto old_size = get_size(rep);
+                try
+                {
+                    auto &data = get_data_part(rep);
+                    if constexpr (reservable_represent<Represent>)
+                    {
+                        using policy = typename represent_growth_policy<std::remove_cvref_t<Represent>>::type;
+                        if (data.capacity() < new_size)
+                            data.reserve(policy::next_capacity(data.capacity(), new_size));
+                    }
+                    data.resize(new_size);
+                }
+                catch (...)
+                {
+                    set_error_or_throw<io_exception>(err, std::errc::not_enough_memory);
+                    return {};
+                }
+                if (zero_end > old_size)
+                    std::fill_n(get_data_part(rep).begin() + old_size, std::min(zero_end, new_size) - old_size, std::byte{});
+                return new_size;
+            }
+        }
 
+        template <write_represent Represent>
+        long_size_t do_truncate(Represent &rep, long_size_t size, error_code_ptr err)
+        {
             std::size_t new_size = narrow_cast(size);
+            return do_grow(rep, new_size, new_size, err);
+        }
+
+        template <reservable_represent Represent>
+        void reserve(Represent &rep, long_size_t capacity, error_code_ptr err = {})
+        {
+            if (!in_size_t_range(capacity))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return;
+            }
             try
             {
-                get_data_part(rep).resize(new_size);
+                get_data_part(rep).reserve(narrow_cast(capacity));
             }
             catch (...)
             {
                 set_error_or_throw<io_exception>(err, std::errc::not_enough_memory);
-                return {};
+                return;
             }
-            return new_size;
+            clear_error(err);
         }
 
         template <truncatable_represent Represent>
@@ -259,7 +367,7 @@ namespace io
             auto new_pos = get_pos_part(rep) + buf.size();
             if (get_size(rep) < new_pos)
             {
-                do_truncate(rep, new_pos, err);
+                do_grow(rep, new_pos, get_pos_part(rep), err);
                 if (has_error(err))
                     return {};
             }
@@ -272,6 +380,53 @@ namespace io
             return {buf.end(), buf.end()};
         }
 
+        template <write_represent Represent>
+        const_buffer write_at(Represent &rep, long_size_t off, const_buffer buf, error_code_ptr err)
+        {
+            if (!in_size_t_range(off + buf.size()))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return buf;
+            }
+            auto end = narrow_cast(off + buf.size());
+            if (get_size(rep) < end)
+            {
+                do_grow(rep, end, narrow_cast(off), err);
+                if (has_error(err))
+                    return buf;
+            }
+
+            std::copy(buf.begin(), buf.end(), get_data_part(rep).begin() + narrow_cast(off));
+
+            clear_error(err);
+            return {buf.end(), buf.end()};
+        }
+
+        template <write_represent Represent>
+        std::size_t write_vec(Represent &rep, const_buffers bufs, error_code_ptr err)
+        { // grow once for the whole vector, then copy
+            std::size_t total = 0;
+            for (auto buf : bufs)
+                total += buf.size();
+
+            auto new_pos = get_pos_part(rep) + total;
+            if (get_size(rep) < new_pos)
+            {
+                do_grow(rep, new_pos, get_pos_part(rep), err);
+                if (has_error(err))
+                    return {};
+            }
+
+            auto ditr = get_pos_iter(rep);
+            for (auto buf : bufs)
+                ditr = std::copy(buf.begin(), buf.end(), ditr);
+
+            set_pos_part(rep, new_pos);
+
+            clear_error(err);
+            return total;
+        }
+
         template <write_represent Represent>
         buffer_wr_view view_wr(Represent &rep, long_offset_range h, error_code_ptr err = {})
         { // write_map
@@ -319,15 +474,414 @@ namespace io
         std::size_t &pos;
     };
 
-    struct vector_buffer_represent
+    // grows geometrically, new bytes are only zero filled where nothing is written over them
+    // when Alloc default initializes
+    template <typename Alloc = std::allocator<std::byte>>
+    struct basic_vector_buffer_represent
     {
-        std::vector<std::byte> data;
+        std::vector<std::byte, Alloc> data;
         std::size_t pos{0};
     };
+    using vector_buffer_represent = basic_vector_buffer_represent<>;
+
+    // storage of memory_device<>, growing without zero filling
+    using default_init_buffer_represent = basic_vector_buffer_represent<default_init_allocator<std::byte>>;
+
+    // storage aligned for direct io, to 4096 bytes unless data is constructed with another
+    // aligned_byte_allocator(alignment)
+    using aligned_byte_allocator = default_init_allocator<std::byte, aligned_allocator<std::byte>>;
+    using aligned_buffer_represent = basic_vector_buffer_represent<aligned_byte_allocator>;
+
+    // Rope of fixed size chunks, growing never moves the bytes already written.
+    // Bytes of the last chunk past size are uninitialized, they are zero filled when size grows over them.
+    struct chunked_buffer_represent
+    {
+        static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+        std::vector<std::unique_ptr<std::byte[]>> chunks;
+        std::size_t chunk_size{default_chunk_size};
+        std::size_t size{0};
+        std::size_t pos{0};
+    };
+
+    template <typename Represent>
+    concept chunked_represent = requires(std::remove_cvref_t<Represent> &rep) {
+        {
+            rep.chunks[0].get()
+        } -> std::same_as<std::byte *>;
+        {
+            rep.chunk_size
+        } -> std::convertible_to<std::size_t>;
+        {
+            rep.size
+        } -> std::convertible_to<std::size_t>;
+        {
+            rep.pos
+        } -> std::convertible_to<std::size_t>;
+    };
+
+    // read view of a chunked represent, a scatter list of the chunks it spans.
+    // address() is contiguous only within one chunk, a view crossing chunks copies on demand.
+    class chunked_rd_view
+    {
+    public:
+        chunked_rd_view() noexcept = default;
+        explicit chunked_rd_view(const_buffer single) noexcept : m_first(single) {}
+        explicit chunked_rd_view(std::vector<const_buffer> segments) noexcept : m_segments(std::move(segments)) {}
+
+        const_buffers buffers() const noexcept
+        {
+            if (m_segments.empty())
+                return {&m_first, 1};
+            return m_segments;
+        }
+
+        const_buffer address() const
+        {
+            if (m_segments.empty())
+                return m_first;
+            if (m_copy.empty())
+                for (auto seg : m_segments)
+                    m_copy.insert(m_copy.end(), seg.begin(), seg.end());
+            return m_copy;
+        }
+
+    private:
+        const_buffer m_first;
+        std::vector<const_buffer> m_segments;
+        mutable std::vector<std::byte> m_copy;
+    };
+
+    // write view of a chunked represent, address() of a view crossing chunks returns a copy
+    // which is scattered back into the chunks when the view is destroyed
+    class chunked_wr_view
+    {
+    public:
+        chunked_wr_view() noexcept = default;
+        explicit chunked_wr_view(mutable_buffer single) noexcept : m_first(single) {}
+        explicit chunked_wr_view(std::vector<mutable_buffer> segments) noexcept : m_segments(std::move(segments)) {}
+
+        chunked_wr_view(chunked_wr_view &&rhs) noexcept
+            : m_first(rhs.m_first), m_segments(std::move(rhs.m_segments)), m_copy(std::move(rhs.m_copy)),
+              m_copied(std::exchange(rhs.m_copied, false))
+        {
+        }
+        chunked_wr_view &operator=(chunked_wr_view &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                write_back();
+                m_first = rhs.m_first;
+                m_segments = std::move(rhs.m_segments);
+                m_copy = std::move(rhs.m_copy);
+                m_copied = std::exchange(rhs.m_copied, false);
+            }
+            return *this;
+        }
+        ~chunked_wr_view() { write_back(); }
+
+        mutable_buffers buffers() noexcept
+        {
+            if (m_segments.empty())
+                return {&m_first, 1};
+            return m_segments;
+        }
+
+        mutable_buffer address()
+        {
+            if (m_segments.empty())
+                return m_first;
+            if (!m_copied)
+            {
+                for (auto seg : m_segments)
+                    m_copy.insert(m_copy.end(), seg.begin(), seg.end());
+                m_copied = true;
+            }
+            return m_copy;
+        }
+
+    private:
+        void write_back() noexcept
+        {
+            if (!m_copied)
+                return;
+            auto src = m_copy.data();
+            for (auto seg : m_segments)
+            {
+                std::memcpy(seg.data(), src, seg.size());
+                src += seg.size();
+            }
+            m_copied = false;
+        }
+
+        mutable_buffer m_first;
+        std::vector<mutable_buffer> m_segments;
+        std::vector<std::byte> m_copy;
+        bool m_copied{false};
+    };
+
+    namespace impl
+    {
+        // call fn(std::byte*, std::size_t) for each chunk piece of [off, off + n), which must be allocated
+        template <chunked_represent Represent, typename Fn>
+        void for_each_chunk(Represent &rep, std::size_t off, std::size_t n, Fn &&fn)
+        {
+            while (n != 0)
+            {
+                auto idx = off / rep.chunk_size;
+                auto first = off % rep.chunk_size;
+                auto len = std::min(n, rep.chunk_size - first);
+                fn(rep.chunks[idx].get() + first, len);
+                off += len;
+                n -= len;
+            }
+        }
+
+        // make size new_size, zero filling the bytes from the old size up to zero_end
+        template <chunked_represent Represent>
+        long_size_t chunked_resize(Represent &rep, std::size_t new_size, std::size_t zero_end, error_code_ptr err)
+        {
+            auto needed = (new_size + rep.chunk_size - 1) / rep.chunk_size;
+            try
+            {
+                if (needed < rep.chunks.size())
+                    rep.chunks.resize(needed);
+                while (rep.chunks.size() < needed)
+                    rep.chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(rep.chunk_size));
+            }
+            catch (...)
+            {
+                set_error_or_throw<io_exception>(err, std::errc::not_enough_memory);
+                return {};
+            }
+            if (zero_end > rep.size)
+                for_each_chunk(rep, rep.size, zero_end - rep.size, [](std::byte *p, std::size_t n) { std::memset(p, 0, n); });
+            rep.size = new_size;
+            clear_error(err);
+            return new_size;
+        }
+
+        template <chunked_represent Represent>
+        long_size_t offset(const Represent &rep, error_code_ptr ec = {}) noexcept
+        { // sequence
+            clear_error(ec);
+            return rep.pos;
+        }
+
+        template <chunked_represent Represent>
+        bool is_eof(const Represent &rep, error_code_ptr ec = {}) noexcept
+        { // is_eofer
+            clear_error(ec);
+            return rep.pos >= rep.size;
+        }
+
+        template <chunked_represent Represent>
+        long_size_t seek(Represent &rep, long_size_t offset, error_code_ptr ec = {})
+        { // random
+            if (!in_size_t_range(offset))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return rep.pos;
+            }
+            clear_error(ec);
+            return rep.pos = narrow_cast(offset);
+        }
+
+        template <chunked_represent Represent>
+        long_size_t size(const Represent &rep, error_code_ptr ec = {}) noexcept
+        { // sizer
+            clear_error(ec);
+            return rep.size;
+        }
+
+        template <chunked_represent Represent>
+        mutable_buffer read_at(const Represent &rep, long_size_t off, mutable_buffer buf, error_code_ptr ec) noexcept
+        {
+            clear_error(ec);
+            if (buf.empty() || off >= rep.size)
+                return buf.first(0);
+
+            auto n = std::min(std::size_t(rep.size - off), buf.size());
+            auto dst = buf.data();
+            for_each_chunk(rep, narrow_cast(off), n, [&dst](const std::byte *p, std::size_t len) {
+                std::memcpy(dst, p, len);
+                dst += len;
+            });
+            return buf.first(n);
+        }
+
+        template <chunked_represent Represent>
+        mutable_buffer read(Represent &rep, mutable_buffer buf, error_code_ptr ec) noexcept
+        {
+            auto res = read_at(rep, rep.pos, buf, ec);
+            rep.pos += res.size();
+            return res;
+        }
+
+        template <chunked_represent Represent>
+        std::size_t read_vec(Represent &rep, mutable_buffers bufs, error_code_ptr ec) noexcept
+        {
+            clear_error(ec);
+            std::size_t total = 0;
+            for (auto buf : bufs)
+            {
+                auto n = read(rep, buf, ec).size();
+                total += n;
+                if (n < buf.size())
+                    break;
+            }
+            return total;
+        }
+
+        template <chunked_represent Represent>
+        chunked_rd_view view_rd(const Represent &rep, long_offset_range h, error_code_ptr ec = {})
+        { // read_map
+            APE_Expects(is_valid_range(h));
+
+            if (h.end == unknown_offset)
+                h.end = long_offset_t(rep.size);
+            if (h.end > long_offset_t(rep.size))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return {};
+            }
+            clear_error(ec);
+            if (h.begin == h.end)
+                return {};
+
+            auto first = narrow_cast(long_size_t(h.begin));
+            auto n = narrow_cast(ape::size(h));
+            if (first / rep.chunk_size == (first + n - 1) / rep.chunk_size)
+                return chunked_rd_view(const_buffer(rep.chunks[first / rep.chunk_size].get() + first % rep.chunk_size, n));
+
+            std::vector<const_buffer> segments;
+            for_each_chunk(rep, first, n, [&](const std::byte *p, std::size_t len) { segments.emplace_back(p, len); });
+            return chunked_rd_view(std::move(segments));
+        }
+
+        template <chunked_represent Represent>
+        void reserve(Represent &rep, long_size_t capacity, error_code_ptr err = {})
+        { // only the chunk table, chunks are allocated as they are written
+            if (!in_size_t_range(capacity))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return;
+            }
+            try
+            {
+                rep.chunks.reserve((narrow_cast(capacity) + rep.chunk_size - 1) / rep.chunk_size);
+            }
+            catch (...)
+            {
+                set_error_or_throw<io_exception>(err, std::errc::not_enough_memory);
+                return;
+            }
+            clear_error(err);
+        }
+
+        template <chunked_represent Represent>
+        long_size_t truncate(Represent &rep, long_size_t new_size, error_code_ptr err = {})
+        {
+            if (!in_size_t_range(new_size))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return {};
+            }
+            return chunked_resize(rep, narrow_cast(new_size), narrow_cast(new_size), err);
+        }
+
+        template <chunked_represent Represent>
+        const_buffer write_at(Represent &rep, long_size_t off, const_buffer buf, error_code_ptr err)
+        {
+            if (!in_size_t_range(off + buf.size()))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return buf;
+            }
+            auto first = narrow_cast(off);
+            auto end = first + buf.size();
+            if (rep.size < end)
+            {
+                chunked_resize(rep, end, first, err); // the written bytes need no zero fill
+                if (has_error(err))
+                    return buf;
+            }
+
+            auto src = buf.data();
+            for_each_chunk(rep, first, buf.size(), [&src](std::byte *p, std::size_t len) {
+                std::memcpy(p, src, len);
+                src += len;
+            });
+            clear_error(err);
+            return buf.last(0);
+        }
+
+        template <chunked_represent Represent>
+        const_buffer write(Represent &rep, const_buffer buf, error_code_ptr err)
+        { // write
+            auto res = write_at(rep, rep.pos, buf, err);
+            rep.pos += buf.size() - res.size();
+            return res;
+        }
+
+        template <chunked_represent Represent>
+        std::size_t write_vec(Represent &rep, const_buffers bufs, error_code_ptr err)
+        {
+            std::size_t total = 0;
+            for (auto buf : bufs)
+            {
+                if (!write(rep, buf, err).empty())
+                    break;
+                total += buf.size();
+            }
+            return total;
+        }
+
+        template <chunked_represent Represent>
+        chunked_wr_view view_wr(Represent &rep, long_offset_range h, error_code_ptr err = {})
+        { // write_map
+            APE_Expects(is_valid_range(h));
+
+            if (h.end == unknown_offset)
+                h.end = long_offset_t(rep.size);
+            if (!in_size_t_range(h.end))
+            {
+                set_error_or_throw<io_exception>(err, std::errc::value_too_large);
+                return {};
+            }
+            auto first = narrow_cast(long_size_t(h.begin));
+            auto end = narrow_cast(long_size_t(h.end));
+            if (end > rep.size)
+            {
+                chunked_resize(rep, end, end, err);
+                if (has_error(err))
+                    return {};
+            }
+            clear_error(err);
+            if (first == end)
+                return {};
+
+            if (first / rep.chunk_size == (end - 1) / rep.chunk_size)
+                return chunked_wr_view(mutable_buffer(rep.chunks[first / rep.chunk_size].get() + first % rep.chunk_size, end - first));
+
+            std::vector<mutable_buffer> segments;
+            for_each_chunk(rep, first, end - first, [&](std::byte *p, std::size_t len) { segments.emplace_back(p, len); });
+            return chunked_wr_view(std::move(segments));
+        }
+
+        template <chunked_represent Represent>
+        void sync(Represent &rep, error_code_ptr err = {})
+        {
+            unused(rep);
+
+            clear_error(err);
+        }
+    }
 
     // imp [ sequence, forward, random ] [ is_eofer, sizer]
-    template <typename Represent = vector_buffer_represent>
-        requires read_represent<Represent> || write_represent<Represent> || truncatable_represent<Represent>
+    template <typename Represent = default_init_buffer_represent>
+        requires read_represent<Represent> || write_represent<Represent> || truncatable_represent<Represent> ||
+                 chunked_represent<Represent>
     struct memory_device
     {
         explicit memory_device(Represent rep = {}) noexcept(std::is_nothrow_move_constructible_v<Represent>)
@@ -367,7 +921,17 @@ namespace io
             return impl::read(this->m_rep, buf, ec);
         }
 
-        buffer_rd_view view_rd(long_offset_range h, error_code_ptr ec = {})
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+        { // vec_reader
+            return impl::read_vec(this->m_rep, bufs, ec);
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {}) const
+        { // positional_reader
+            return impl::read_at(this->m_rep, off, buf, ec);
+        }
+
+        auto view_rd(long_offset_range h, error_code_ptr ec = {})
         { // read_map
             return impl::view_rd(this->m_rep, h, ec);
         }
@@ -377,8 +941,18 @@ namespace io
             return impl::write(m_rep, buf, ec);
         }
 
-        buffer_wr_view view_wr(long_offset_range h, error_code_ptr ec = {})
-        { // read_map
+        std::size_t write_vec(const_buffers bufs, error_code_ptr ec = {})
+        { // vec_writer
+            return impl::write_vec(m_rep, bufs, ec);
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            return impl::write_at(m_rep, off, buf, ec);
+        }
+
+        auto view_wr(long_offset_range h, error_code_ptr ec = {})
+        { // write_map
             return impl::view_wr(m_rep, h, ec);
         }
 
@@ -392,6 +966,13 @@ namespace io
             return impl::truncate(m_rep, size, err);
         }
 
+        // capacity hint, writes up to capacity bytes do not reallocate
+        void reserve(long_size_t capacity, error_code_ptr err = {})
+            requires reservable_represent<Represent> || chunked_represent<Represent>
+        {
+            impl::reserve(m_rep, capacity, err);
+        }
+
     protected:
         Represent m_rep;
     };
@@ -433,8 +1014,22 @@ namespace io
         { // reader
             clear_error(ec);
             std::fill(buf.begin(), buf.end(), std::byte{});
+            m_pos += buf.size();
             return buf;
         }
+
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+        { // vec_reader
+            clear_error(ec);
+            std::size_t total = 0;
+            for (auto buf : bufs)
+            {
+                std::fill(buf.begin(), buf.end(), std::byte{});
+                total += buf.size();
+            }
+            m_pos += total;
+            return total;
+        }
     };
 
     class fill : public pseudo_common
@@ -464,6 +1059,15 @@ namespace io
             m_pos += buf.size();
             return buf;
         }
+
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+        { // vec_reader
+            std::size_t total = 0;
+            for (auto buf : bufs)
+                total += read(buf, ec).size();
+            clear_error(ec);
+            return total;
+        }
     };
 
     struct null
@@ -475,6 +1079,16 @@ namespace io
             return {r.end(), r.end()};
         }
 
+        std::size_t write_vec(const_buffers bufs, error_code_ptr ec = {})
+        { // vec_writer
+            clear_error(ec);
+            std::size_t total = 0;
+            for (auto buf : bufs)
+                total += buf.size();
+            m_pos += total;
+            return total;
+        }
+
         void sync(error_code_ptr ec = {}) { clear_error(ec); }
 
         long_size_t truncate(long_size_t size, error_code_ptr ec = {})
@@ -0,0 +1,452 @@
+#pragma once
+#ifndef APE_ESTL_IO_METERED_H
+#define APE_ESTL_IO_METERED_H
+#include <ape/estl/io/iocore.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+
+// APE_ESTL_IO_METERING=0 turns metered_device into a plain forwarder
+#ifndef APE_ESTL_IO_METERING
+#define APE_ESTL_IO_METERING 1
+#endif
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    inline constexpr bool metering_enabled = APE_ESTL_IO_METERING != 0;
+
+    enum class io_op : unsigned
+    {
+        read,
+        read_vec,
+        read_at,
+        write,
+        write_vec,
+        write_at,
+        seek,
+        sync,
+        truncate,
+        view_rd,
+        view_wr,
+    };
+    inline constexpr std::size_t io_op_count = std::size_t(io_op::view_wr) + 1;
+
+    // Log-linear latency histogram in nanoseconds: each power of two range is split into
+    // sub_buckets linear buckets, latencies of 2^max_exponent ns or more share the last one.
+    class latency_histogram
+    {
+    public:
+        static constexpr unsigned sub_bits = 2;
+        static constexpr unsigned sub_buckets = 1u << sub_bits;
+        static constexpr unsigned max_exponent = 32;
+        static constexpr std::size_t bucket_count = (max_exponent - sub_bits + 1) * sub_buckets;
+
+        static constexpr std::size_t bucket_of(std::uint64_t ns) noexcept
+        {
+            if (ns < sub_buckets)
+                return std::size_t(ns);
+            unsigned e = unsigned(std::bit_width(ns)) - 1;
+            if (e >= max_exponent)
+                return bucket_count - 1;
+            return (e - sub_bits + 1) * sub_buckets + std::size_t((ns >> (e - sub_bits)) & (sub_buckets - 1));
+        }
+
+        // smallest latency falling into bucket idx
+        static constexpr std::uint64_t bucket_floor(std::size_t idx) noexcept
+        {
+            if (idx < sub_buckets)
+                return idx;
+            auto e = unsigned(idx / sub_buckets) + sub_bits - 1;
+            return (std::uint64_t(sub_buckets + idx % sub_buckets)) << (e - sub_bits);
+        }
+
+        std::uint64_t count(std::size_t idx) const noexcept { return m_counts[idx]; }
+
+        std::uint64_t total() const noexcept
+        {
+            std::uint64_t n = 0;
+            for (auto c : m_counts)
+                n += c;
+            return n;
+        }
+
+        // lower bound of the bucket holding the p-th percentile, p in [0, 100]
+        std::uint64_t percentile(double p) const noexcept
+        {
+            auto n = total();
+            if (n == 0)
+                return 0;
+            auto rank = std::uint64_t(p / 100.0 * double(n - 1));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < bucket_count; ++i)
+            {
+                seen += m_counts[i];
+                if (seen > rank)
+                    return bucket_floor(i);
+            }
+            return bucket_floor(bucket_count - 1);
+        }
+
+        void add(std::size_t idx, std::uint64_t n) noexcept { m_counts[idx] += n; }
+
+        latency_histogram &merge(const latency_histogram &rhs) noexcept
+        {
+            for (std::size_t i = 0; i < bucket_count; ++i)
+                m_counts[i] += rhs.m_counts[i];
+            return *this;
+        }
+
+    private:
+        std::array<std::uint64_t, bucket_count> m_counts{};
+    };
+
+    struct op_stats
+    {
+        std::uint64_t count{0};
+        std::uint64_t bytes{0};
+        std::uint64_t errors{0};
+        std::uint64_t total_ns{0};
+        latency_histogram latency;
+
+        op_stats &merge(const op_stats &rhs) noexcept
+        {
+            count += rhs.count;
+            bytes += rhs.bytes;
+            errors += rhs.errors;
+            total_ns += rhs.total_ns;
+            latency.merge(rhs.latency);
+            return *this;
+        }
+    };
+
+    // point in time copy of the counters of one or more metered devices
+    struct meter_snapshot
+    {
+        std::array<op_stats, io_op_count> ops{};
+
+        const op_stats &operator[](io_op op) const noexcept { return ops[std::size_t(op)]; }
+        op_stats &operator[](io_op op) noexcept { return ops[std::size_t(op)]; }
+
+        meter_snapshot &merge(const meter_snapshot &rhs) noexcept
+        {
+            for (std::size_t i = 0; i < io_op_count; ++i)
+                ops[i].merge(rhs.ops[i]);
+            return *this;
+        }
+    };
+
+    namespace impl
+    {
+        // Counters of one device, striped over shards so that each thread, up to shard_count of them,
+        // updates its own cache lines with relaxed atomics. snapshot() sums the shards.
+        class meter
+        {
+        public:
+            static constexpr std::size_t shard_count = 8;
+
+            void record(io_op op, std::uint64_t ns, std::uint64_t bytes, bool failed) noexcept
+            {
+                auto &c = m_shards[thread_slot()].ops[std::size_t(op)];
+                c.count.fetch_add(1, std::memory_order_relaxed);
+                c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+                c.total_ns.fetch_add(ns, std::memory_order_relaxed);
+                if (failed)
+                    c.errors.fetch_add(1, std::memory_order_relaxed);
+                c.latency[latency_histogram::bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            meter_snapshot snapshot() const noexcept
+            {
+                meter_snapshot res;
+                for (auto &shard : m_shards)
+                    for (std::size_t i = 0; i < io_op_count; ++i)
+                    {
+                        auto &c = shard.ops[i];
+                        auto &r = res.ops[i];
+                        r.count += c.count.load(std::memory_order_relaxed);
+                        r.bytes += c.bytes.load(std::memory_order_relaxed);
+                        r.errors += c.errors.load(std::memory_order_relaxed);
+                        r.total_ns += c.total_ns.load(std::memory_order_relaxed);
+                        for (std::size_t b = 0; b < latency_histogram::bucket_count; ++b)
+                            r.latency.add(b, c.latency[b].load(std::memory_order_relaxed));
+                    }
+                return res;
+            }
+
+            void reset() noexcept
+            {
+                for (auto &shard : m_shards)
+                    for (auto &c : shard.ops)
+                    {
+                        c.count.store(0, std::memory_order_relaxed);
+                        c.bytes.store(0, std::memory_order_relaxed);
+                        c.errors.store(0, std::memory_order_relaxed);
+                        c.total_ns.store(0, std::memory_order_relaxed);
+                        for (auto &b : c.latency)
+                            b.store(0, std::memory_order_relaxed);
+                    }
+            }
+
+        private:
+            struct counters
+            {
+                std::atomic<std::uint64_t> count{0}, bytes{0}, errors{0}, total_ns{0};
+                std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> latency{};
+            };
+            struct alignas(64) shard
+            {
+                std::array<counters, io_op_count> ops;
+            };
+
+            static std::size_t thread_slot() noexcept
+            {
+                static std::atomic<std::size_t> next{0};
+                thread_local std::size_t slot = next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+                return slot;
+            }
+
+            std::array<shard, shard_count> m_shards;
+        };
+
+        // times one operation, an exception escaping it counts as an error
+        class meter_scope
+        {
+        public:
+            meter_scope(meter &m, io_op op, error_code_ptr ec) noexcept
+                : m_meter(m), m_op(op), m_ec(ec), m_exceptions(std::uncaught_exceptions()),
+                  m_start(std::chrono::steady_clock::now())
+            {
+            }
+            meter_scope(const meter_scope &) = delete;
+            meter_scope &operator=(const meter_scope &) = delete;
+            ~meter_scope()
+            {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+                bool failed = has_error(m_ec) || std::uncaught_exceptions() > m_exceptions;
+                m_meter.record(m_op, std::uint64_t(ns), m_bytes, failed);
+            }
+
+            void bytes(std::uint64_t n) noexcept { m_bytes = n; }
+
+        private:
+            meter &m_meter;
+            io_op m_op;
+            error_code_ptr m_ec;
+            int m_exceptions;
+            std::uint64_t m_bytes{0};
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+        struct no_meter
+        {
+        };
+        struct no_meter_scope
+        {
+            void bytes(std::uint64_t) noexcept {}
+        };
+    }
+
+    // Forwards every io operation to the underlying device, recording per operation counts,
+    // bytes, errors and latency histograms. With Enabled false (or APE_ESTL_IO_METERING=0)
+    // nothing is recorded or allocated and the adaptor is a plain forwarder.
+    // imp [ the concepts Device implements ]
+    template <typename Device, bool Enabled = metering_enabled>
+    class metered_device
+    {
+        Device &m_device;
+        [[no_unique_address]] std::conditional_t<Enabled, std::unique_ptr<impl::meter>, impl::no_meter> m_meter;
+
+        auto scope(io_op op, error_code_ptr ec)
+        {
+            if constexpr (Enabled)
+                return impl::meter_scope(*m_meter, op, ec);
+            else
+                return impl::no_meter_scope{};
+        }
+
+    public:
+        explicit metered_device(Device &d) : m_device(d)
+        {
+            if constexpr (Enabled)
+                m_meter = std::make_unique<impl::meter>();
+        }
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+        const Device &underlying() const noexcept
+        {
+            return m_device;
+        }
+
+        meter_snapshot snapshot() const noexcept
+        {
+            if constexpr (Enabled)
+                return m_meter->snapshot();
+            else
+                return {};
+        }
+
+        void reset_meter() noexcept
+        {
+            if constexpr (Enabled)
+                m_meter->reset();
+        }
+
+        template <option_tag Tag>
+        auto get_option(Tag) const
+            requires supports_option<Device, Tag>
+        {
+            return m_device.get_option(Tag{});
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const
+            requires sequence<Device>
+        { // sequence
+            return io::offset(m_device, ec);
+        }
+
+        long_size_t seek(long_size_t off, error_code_ptr ec = {})
+            requires random<Device>
+        { // random
+            auto s = scope(io_op::seek, ec);
+            return io::seek(m_device, off, ec);
+        }
+
+        long_size_t seek_forward(long_size_t off, error_code_ptr ec = {})
+            requires forward<Device>
+        { // forward
+            auto s = scope(io_op::seek, ec);
+            return io::seek_forward(m_device, off, ec);
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+            requires is_eofer<Device>
+        { // is_eofer
+            return io::is_eof(m_device, ec);
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // sizer
+            return io::size(m_device, ec);
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+            requires reader<Device>
+        { // reader
+            auto s = scope(io_op::read, ec);
+            auto res = io::read(m_device, buf, ec);
+            s.bytes(res.size());
+            return res;
+        }
+
+        std::size_t read_vec(mutable_buffers bufs, error_code_ptr ec = {})
+            requires vec_reader<Device>
+        { // vec_reader
+            auto s = scope(io_op::read_vec, ec);
+            auto res = io::read_vec(m_device, bufs, ec);
+            s.bytes(res);
+            return res;
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {})
+            requires positional_reader<Device>
+        { // positional_reader
+            auto s = scope(io_op::read_at, ec);
+            auto res = io::read_at(m_device, off, buf, ec);
+            s.bytes(res.size());
+            return res;
+        }
+
+        auto view_rd(long_offset_range rng, error_code_ptr ec = {})
+            requires read_map<Device>
+        { // read_map
+            auto s = scope(io_op::view_rd, ec);
+            auto res = io::view_rd(m_device, rng, ec);
+            s.bytes(io::address(res).size());
+            return res;
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+            requires writer<Device>
+        { // writer
+            auto s = scope(io_op::write, ec);
+            auto res = io::write(m_device, buf, ec);
+            s.bytes(buf.size() - res.size());
+            return res;
+        }
+
+        std::size_t write_vec(const_buffers bufs, error_code_ptr ec = {})
+            requires vec_writer<Device>
+        { // vec_writer
+            auto s = scope(io_op::write_vec, ec);
+            auto res = io::write_vec(m_device, bufs, ec);
+            s.bytes(res);
+            return res;
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+            requires positional_writer<Device>
+        { // positional_writer
+            auto s = scope(io_op::write_at, ec);
+            auto res = io::write_at(m_device, off, buf, ec);
+            s.bytes(buf.size() - res.size());
+            return res;
+        }
+
+        auto view_wr(long_offset_range rng, error_code_ptr ec = {})
+            requires write_map<Device>
+        { // write_map
+            auto s = scope(io_op::view_wr, ec);
+            return io::view_wr(m_device, rng, ec);
+        }
+
+        void sync(error_code_ptr ec = {})
+            requires syncer<Device>
+        { // syncer
+            auto s = scope(io_op::sync, ec);
+            io::sync(m_device, ec);
+        }
+
+        long_size_t truncate(long_size_t n, error_code_ptr ec = {})
+            requires truncater<Device>
+        { // truncater
+            auto s = scope(io_op::truncate, ec);
+            return io::truncate(m_device, n, ec);
+        }
+
+        void advise(long_offset_range rng, access_pattern pattern, error_code_ptr ec = {})
+            requires advisor<Device>
+        { // advisor, a hint, not recorded
+            io::advise(m_device, rng, pattern, ec);
+        }
+
+        long_size_t find_data(long_size_t off, error_code_ptr ec = {}) const
+            requires extent_finder<Device>
+        { // extent_finder, not recorded
+            return io::find_data(m_device, off, ec);
+        }
+
+        long_size_t find_hole(long_size_t off, error_code_ptr ec = {}) const
+            requires extent_finder<Device>
+        { // extent_finder, not recorded
+            return io::find_hole(m_device, off, ec);
+        }
+
+        void punch_hole(long_offset_range rng, error_code_ptr ec = {})
+            requires hole_puncher<Device>
+        { // hole_puncher, not recorded
+            io::punch_hole(m_device, rng, ec);
+        }
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_METERED_H
@@ -0,0 +1,460 @@
+#pragma once
+#ifndef APE_ESTL_IO_PIPE_H
+#define APE_ESTL_IO_PIPE_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    namespace impl
+    {
+        // Storage shared by the two ends of a ring pipe. head counts bytes written, tail bytes read,
+        // each is stored by one side only. An end closes by setting closed_bit in its counter, which
+        // also wakes the other side waiting on it.
+        struct ring_pipe_state
+        {
+            static constexpr std::uint64_t closed_bit = std::uint64_t(1) << 63;
+
+            explicit ring_pipe_state(std::size_t cap)
+                : capacity(std::bit_ceil(std::max<std::size_t>(cap, 64))),
+                  data(std::make_unique_for_overwrite<std::byte[]>(capacity))
+            {
+            }
+
+            std::size_t capacity;
+            std::unique_ptr<std::byte[]> data;
+            alignas(64) std::atomic<std::uint64_t> head{0};
+            alignas(64) std::atomic<std::uint64_t> tail{0};
+        };
+    }
+
+    class ring_pipe_writer;
+    class ring_pipe_reader;
+
+    // contiguous free region of a ring pipe, published to the reader by commit() or on destruction
+    class ring_pipe_wr_view
+    {
+    public:
+        ring_pipe_wr_view() noexcept = default;
+        ring_pipe_wr_view(ring_pipe_writer *owner, mutable_buffer data) noexcept : m_owner(owner), m_data(data) {}
+        ring_pipe_wr_view(ring_pipe_wr_view &&rhs) noexcept
+            : m_owner(std::exchange(rhs.m_owner, nullptr)), m_data(rhs.m_data)
+        {
+        }
+        ring_pipe_wr_view &operator=(ring_pipe_wr_view &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                commit(m_data.size());
+                m_owner = std::exchange(rhs.m_owner, nullptr);
+                m_data = rhs.m_data;
+            }
+            return *this;
+        }
+        ~ring_pipe_wr_view() { commit(m_data.size()); }
+
+        mutable_buffer address() const noexcept { return m_data; }
+
+        // publish the first n bytes only and end the view
+        inline void commit(std::size_t n) noexcept;
+
+    private:
+        ring_pipe_writer *m_owner{nullptr};
+        mutable_buffer m_data;
+    };
+
+    // contiguous readable region of a ring pipe, released to the writer by consume() or on destruction
+    class ring_pipe_rd_view
+    {
+    public:
+        ring_pipe_rd_view() noexcept = default;
+        ring_pipe_rd_view(ring_pipe_reader *owner, const_buffer data) noexcept : m_owner(owner), m_data(data) {}
+        ring_pipe_rd_view(ring_pipe_rd_view &&rhs) noexcept
+            : m_owner(std::exchange(rhs.m_owner, nullptr)), m_data(rhs.m_data)
+        {
+        }
+        ring_pipe_rd_view &operator=(ring_pipe_rd_view &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                consume(m_data.size());
+                m_owner = std::exchange(rhs.m_owner, nullptr);
+                m_data = rhs.m_data;
+            }
+            return *this;
+        }
+        ~ring_pipe_rd_view() { consume(m_data.size()); }
+
+        const_buffer address() const noexcept { return m_data; }
+
+        // release the first n bytes only and end the view, the rest is read again by the next call
+        inline void consume(std::size_t n) noexcept;
+
+    private:
+        ring_pipe_reader *m_owner{nullptr};
+        const_buffer m_data;
+    };
+
+    // Producer end of a single producer, single consumer ring pipe. Offsets count bytes written
+    // since creation. write blocks while the ring is full, view_wr reserves the contiguous free
+    // region at offset() so data can be produced in place, one view at a time. Fails with
+    // broken_pipe when it has to wait for space and the reader end is gone. Destroying or closing
+    // the writer marks the end of the stream.
+    // imp [ sequence, sizer ]
+    //     [ writer, write_map, syncer ]
+    class ring_pipe_writer
+    {
+    public:
+        ring_pipe_writer() noexcept = default;
+        explicit ring_pipe_writer(std::shared_ptr<impl::ring_pipe_state> state) noexcept : m_state(std::move(state)) {}
+        ring_pipe_writer(ring_pipe_writer &&rhs) noexcept
+            : m_state(std::move(rhs.m_state)), m_head(rhs.m_head), m_tail_cache(rhs.m_tail_cache)
+        {
+        }
+        ring_pipe_writer &operator=(ring_pipe_writer &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                close();
+                m_state = std::move(rhs.m_state);
+                m_head = rhs.m_head;
+                m_tail_cache = rhs.m_tail_cache;
+            }
+            return *this;
+        }
+        ~ring_pipe_writer() { close(); }
+
+        bool is_open() const noexcept { return m_state != nullptr; }
+        std::size_t capacity() const noexcept { return m_state ? m_state->capacity : 0; }
+
+        void close() noexcept
+        {
+            if (m_state)
+            {
+                m_state->head.fetch_or(impl::ring_pipe_state::closed_bit, std::memory_order_release);
+                m_state->head.notify_all();
+                m_state.reset();
+            }
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_head;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const noexcept
+        { // sizer
+            clear_error(ec);
+            return m_head;
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            while (!buf.empty())
+            {
+                auto region = reserve(buf.size(), ec);
+                if (region.empty())
+                    return buf;
+                std::memcpy(region.data(), buf.data(), region.size());
+                publish(region.size());
+                buf = buf.subspan(region.size());
+            }
+            clear_error(ec);
+            return buf;
+        }
+
+        // rng.begin must be offset(), the view is cut at the end of the ring or of the free space
+        // and so may be shorter than rng. Blocks until some space is free.
+        ring_pipe_wr_view view_wr(long_offset_range rng, error_code_ptr ec = {})
+        { // write_map
+            if (rng.begin != long_offset_t(m_head))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return {};
+            }
+            auto want = rng.end == unknown_offset ? std::size_t(-1)
+                                                  : std::size_t(std::min<long_size_t>(ape::size(rng), SIZE_MAX));
+            if (want == 0)
+            {
+                clear_error(ec);
+                return {};
+            }
+            auto region = reserve(want, ec);
+            if (region.empty())
+                return {};
+            clear_error(ec);
+            return {this, region};
+        }
+
+        // wait until the reader consumed all written bytes
+        void sync(error_code_ptr ec = {})
+        { // syncer
+            if (!check_open(ec))
+                return;
+            auto t = m_state->tail.load(std::memory_order_acquire);
+            while (!(t & impl::ring_pipe_state::closed_bit) && t < m_head)
+            {
+                m_state->tail.wait(t, std::memory_order_acquire);
+                t = m_state->tail.load(std::memory_order_acquire);
+            }
+            if (t & impl::ring_pipe_state::closed_bit && (t & ~impl::ring_pipe_state::closed_bit) < m_head)
+                set_error_or_throw<io_exception>(ec, std::errc::broken_pipe);
+            else
+                clear_error(ec);
+        }
+
+    private:
+        friend class ring_pipe_wr_view;
+
+        bool check_open(error_code_ptr ec)
+        {
+            if (m_state)
+                return true;
+            set_error_or_throw<io_exception>(ec, std::errc::bad_file_descriptor);
+            return false;
+        }
+
+        // contiguous free region of at most n bytes at the head, empty on error
+        mutable_buffer reserve(std::size_t n, error_code_ptr ec)
+        {
+            if (!check_open(ec))
+                return {};
+            auto cap = m_state->capacity;
+            // the tail is read from the shared line only when the cached value leaves less than n free
+            while (cap - (m_head - m_tail_cache) < n)
+            {
+                auto t = m_state->tail.load(std::memory_order_acquire);
+                if (t & impl::ring_pipe_state::closed_bit)
+                {
+                    if (m_head - m_tail_cache != cap)
+                        break; // write what fits, the error comes when waiting
+                    set_error_or_throw<io_exception>(ec, std::errc::broken_pipe);
+                    return {};
+                }
+                m_tail_cache = t;
+                if (m_head - m_tail_cache != cap)
+                    break;
+                m_state->tail.wait(t, std::memory_order_acquire);
+            }
+            auto pos = std::size_t(m_head & (cap - 1));
+            auto len = std::min({n, std::size_t(cap - (m_head - m_tail_cache)), cap - pos});
+            return {m_state->data.get() + pos, len};
+        }
+
+        void publish(std::size_t n) noexcept
+        {
+            if (n == 0 || !m_state)
+                return;
+            m_head += n;
+            m_state->head.store(m_head, std::memory_order_release);
+            m_state->head.notify_one();
+        }
+
+        std::shared_ptr<impl::ring_pipe_state> m_state;
+        std::uint64_t m_head{0};
+        std::uint64_t m_tail_cache{0};
+    };
+
+    // Consumer end of a ring pipe. Offsets count bytes read since creation. read and view_rd
+    // block until data is available and report the end of the stream, an empty result, once the
+    // writer closed and the ring is drained. size() is the number of bytes written so far.
+    // imp [ sequence, forward, sizer, is_eofer ]
+    //     [ reader, read_map ]
+    class ring_pipe_reader
+    {
+    public:
+        ring_pipe_reader() noexcept = default;
+        explicit ring_pipe_reader(std::shared_ptr<impl::ring_pipe_state> state) noexcept : m_state(std::move(state)) {}
+        ring_pipe_reader(ring_pipe_reader &&rhs) noexcept
+            : m_state(std::move(rhs.m_state)), m_tail(rhs.m_tail), m_head_cache(rhs.m_head_cache)
+        {
+        }
+        ring_pipe_reader &operator=(ring_pipe_reader &&rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                close();
+                m_state = std::move(rhs.m_state);
+                m_tail = rhs.m_tail;
+                m_head_cache = rhs.m_head_cache;
+            }
+            return *this;
+        }
+        ~ring_pipe_reader() { close(); }
+
+        bool is_open() const noexcept { return m_state != nullptr; }
+        std::size_t capacity() const noexcept { return m_state ? m_state->capacity : 0; }
+
+        void close() noexcept
+        {
+            if (m_state)
+            {
+                m_state->tail.fetch_or(impl::ring_pipe_state::closed_bit, std::memory_order_release);
+                m_state->tail.notify_all();
+                m_state.reset();
+            }
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_tail;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const noexcept
+        { // sizer
+            clear_error(ec);
+            if (!m_state)
+                return m_tail;
+            return m_state->head.load(std::memory_order_acquire) & ~impl::ring_pipe_state::closed_bit;
+        }
+
+        // true once the writer closed and everything was read, never blocks
+        bool is_eof(error_code_ptr ec = {}) const noexcept
+        { // is_eofer
+            clear_error(ec);
+            if (!m_state)
+                return true;
+            auto h = m_state->head.load(std::memory_order_acquire);
+            return (h & impl::ring_pipe_state::closed_bit) && (h & ~impl::ring_pipe_state::closed_bit) == m_tail;
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            std::size_t done = 0;
+            // at most two regions: up to the end of the ring, then from its start
+            for (int i = 0; i < 2 && done < buf.size(); ++i)
+            {
+                auto region = acquire(buf.size() - done, done == 0, ec);
+                if (region.empty())
+                    break;
+                std::memcpy(buf.data() + done, region.data(), region.size());
+                done += region.size();
+                release(region.size());
+            }
+            if (done != 0)
+                clear_error(ec);
+            return buf.first(done);
+        }
+
+        // discard bytes up to off, stops early at the end of the stream
+        long_size_t seek_forward(long_size_t off, error_code_ptr ec = {})
+        { // forward
+            if (off < m_tail)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return m_tail;
+            }
+            while (m_tail < off)
+            {
+                auto region = acquire(std::size_t(std::min<long_size_t>(off - m_tail, SIZE_MAX)), true, ec);
+                if (region.empty())
+                    return m_tail;
+                release(region.size());
+            }
+            clear_error(ec);
+            return m_tail;
+        }
+
+        // rng.begin must be offset(), the view is cut at the end of the ring or of the written data
+        // and so may be shorter than rng. Blocks until some data is available, empty at the end of the stream.
+        ring_pipe_rd_view view_rd(long_offset_range rng, error_code_ptr ec = {})
+        { // read_map
+            if (rng.begin != long_offset_t(m_tail))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return {};
+            }
+            auto want = rng.end == unknown_offset ? std::size_t(-1)
+                                                  : std::size_t(std::min<long_size_t>(ape::size(rng), SIZE_MAX));
+            if (want == 0)
+            {
+                clear_error(ec);
+                return {};
+            }
+            auto region = acquire(want, true, ec);
+            if (region.empty())
+                return {};
+            return {this, region};
+        }
+
+    private:
+        friend class ring_pipe_rd_view;
+
+        // contiguous readable region of at most n bytes at the tail, waits for data when wait is set.
+        // Empty at the end of the stream, on error or when there is nothing and wait is not set.
+        const_buffer acquire(std::size_t n, bool wait, error_code_ptr ec)
+        {
+            if (!m_state)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::bad_file_descriptor);
+                return {};
+            }
+            clear_error(ec);
+            // the head is read from the shared line only when the cached value is short of n
+            while (m_head_cache - m_tail < n)
+            {
+                auto h = m_state->head.load(std::memory_order_acquire);
+                m_head_cache = h & ~impl::ring_pipe_state::closed_bit;
+                if (m_head_cache != m_tail)
+                    break;
+                if ((h & impl::ring_pipe_state::closed_bit) || !wait)
+                    return {};
+                m_state->head.wait(h, std::memory_order_acquire);
+            }
+            auto cap = m_state->capacity;
+            auto pos = std::size_t(m_tail & (cap - 1));
+            auto len = std::min({n, std::size_t(m_head_cache - m_tail), cap - pos});
+            return {m_state->data.get() + pos, len};
+        }
+
+        void release(std::size_t n) noexcept
+        {
+            if (n == 0 || !m_state)
+                return;
+            m_tail += n;
+            m_state->tail.store(m_tail, std::memory_order_release);
+            m_state->tail.notify_one();
+        }
+
+        std::shared_ptr<impl::ring_pipe_state> m_state;
+        std::uint64_t m_tail{0};
+        std::uint64_t m_head_cache{0};
+    };
+
+    inline void ring_pipe_wr_view::commit(std::size_t n) noexcept
+    {
+        APE_Expects(n <= m_data.size());
+        if (auto owner = std::exchange(m_owner, nullptr))
+            owner->publish(n);
+        m_data = m_data.first(0);
+    }
+
+    inline void ring_pipe_rd_view::consume(std::size_t n) noexcept
+    {
+        APE_Expects(n <= m_data.size());
+        if (auto owner = std::exchange(m_owner, nullptr))
+            owner->release(n);
+        m_data = m_data.first(0);
+    }
+
+    // Create a ring pipe of at least capacity bytes (rounded up to a power of two). Each end is
+    // used by one thread at a time, hand-off needs no lock: the two sides only share the head and
+    // tail counters, on separate cache lines, and wait on them when the ring is full or empty.
+    inline std::pair<ring_pipe_reader, ring_pipe_writer> make_ring_pipe(std::size_t capacity = 64 * 1024)
+    {
+        auto state = std::make_shared<impl::ring_pipe_state>(capacity);
+        return {ring_pipe_reader(state), ring_pipe_writer(state)};
+    }
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_PIPE_H
@@ -0,0 +1,324 @@
+#pragma once
+#ifndef APE_ESTL_IO_READAHEAD_H
+#define APE_ESTL_IO_READAHEAD_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    struct readahead_stats
+    {
+        std::uint64_t direct_reads{0}; // reads passed to the device, readahead off
+        std::uint64_t fetches{0};      // windows filled by the background thread
+        std::uint64_t stalls{0};       // reads which had to wait for a fill, each one grows the window
+    };
+
+    // Read adaptor fetching ahead of sequential scans. Reads continuing where the previous one
+    // ended count as sequential, after trigger of them a background thread fills the window
+    // following the one being consumed, so the device is read while the caller works. The window
+    // doubles from min_window up to max_window whenever the caller catches up with the fill.
+    // A read elsewhere (after a seek) drops the windows and reads the device directly again.
+    // The device offset is owned by the adaptor and the device must not be modified behind it.
+    // imp [ sequence, forward, random ] [ reader, is_eofer, sizer ]
+    template <typename Device>
+        requires reader<Device> && (positional_reader<Device> || random<Device>)
+    class readahead_device
+    {
+        struct window
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity{0};
+            long_size_t begin{0};
+            std::size_t want{0}; // bytes requested, a shorter fill means end of device or error
+            std::size_t size{0};
+            error_code error;
+            enum
+            {
+                idle,
+                pending,
+                filling,
+                ready
+            } state{idle};
+
+            bool contains(long_size_t off) const noexcept { return off >= begin && off - begin < size; }
+        };
+
+    public:
+        static constexpr std::size_t default_min_window = 128 * 1024;
+        static constexpr std::size_t default_max_window = 4 * 1024 * 1024;
+
+        explicit readahead_device(Device &d, std::size_t min_window = default_min_window,
+                                  std::size_t max_window = default_max_window, unsigned trigger = 2)
+            : m_device(d), m_min_window(std::max<std::size_t>(min_window, 1)),
+              m_max_window(std::max(max_window, m_min_window)), m_window(m_min_window),
+              m_trigger(std::max(trigger, 1u))
+        {
+            if constexpr (sequence<Device>)
+                m_pos = m_last_end = io::offset(m_device);
+            m_worker = std::thread([this] { run(); });
+        }
+        readahead_device(const readahead_device &) = delete;
+        readahead_device &operator=(const readahead_device &) = delete;
+        ~readahead_device()
+        {
+            {
+                std::lock_guard lk(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            m_worker.join();
+        }
+
+        Device &underlying() noexcept
+        {
+            return m_device;
+        }
+        const Device &underlying() const noexcept
+        {
+            return m_device;
+        }
+
+        // true while reads are served from readahead windows
+        bool is_active() const noexcept
+        {
+            std::lock_guard lk(m_mutex);
+            return m_streak >= m_trigger;
+        }
+        std::size_t window_size() const noexcept
+        {
+            std::lock_guard lk(m_mutex);
+            return m_window;
+        }
+        readahead_stats stats() const noexcept
+        {
+            std::lock_guard lk(m_mutex);
+            return m_stats;
+        }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        long_size_t seek(long_size_t off, error_code_ptr ec = {}) noexcept
+        { // random
+            clear_error(ec);
+            return m_pos = off;
+        }
+
+        // may run while the background thread reads the device
+        long_size_t size(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // sizer
+            return io::size(m_device, ec);
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const
+            requires sizer<Device>
+        { // is_eofer
+            return m_pos >= io::size(m_device, ec);
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            std::unique_lock lk(m_mutex);
+            if (m_deferred_error)
+            {
+                set_error_or_throw<io_exception>(ec, std::exchange(m_deferred_error, error_code{}));
+                return buf.first(0);
+            }
+
+            if (m_pos != m_last_end)
+            {
+                m_streak = 0;
+                m_window = m_min_window;
+                drop(lk);
+            }
+            if (m_streak < m_trigger)
+                ++m_streak;
+
+            std::size_t done = m_streak < m_trigger ? read_direct(buf, ec) : read_windows(lk, buf, ec);
+            m_pos += done;
+            m_last_end = m_pos;
+            return buf.first(done);
+        }
+
+    private:
+        // wait for a running fill and discard both windows
+        void drop(std::unique_lock<std::mutex> &lk)
+        {
+            m_cv.wait(lk, [this] { return m_next.state != window::filling; });
+            m_next.state = window::idle;
+            m_cur.size = 0;
+        }
+
+        std::size_t read_direct(mutable_buffer buf, error_code_ptr ec)
+        {
+            // the worker is idle here, windows only exist while the streak lasts
+            ++m_stats.direct_reads;
+            if constexpr (positional_reader<Device>)
+            {
+                if (io::supports(m_device, device_caps::positional_reader))
+                    return io::read_at(m_device, m_pos, buf, ec).size();
+            }
+            if constexpr (random<Device>)
+            {
+                io::seek(m_device, m_pos, ec);
+                if (has_error(ec))
+                    return 0;
+            }
+            return io::read(m_device, buf, ec).size();
+        }
+
+        std::size_t read_windows(std::unique_lock<std::mutex> &lk, mutable_buffer buf, error_code_ptr ec)
+        {
+            std::size_t done = 0;
+            clear_error(ec);
+            while (done < buf.size())
+            {
+                auto pos = m_pos + done;
+                if (!m_cur.contains(pos))
+                {
+                    if (m_next.state == window::idle || m_next.begin != pos)
+                    {
+                        drop(lk);
+                        request(pos);
+                    }
+                    if (m_next.state != window::ready)
+                    {
+                        ++m_stats.stalls;
+                        m_window = std::min(m_window * 2, m_max_window);
+                        m_cv.wait(lk, [this] { return m_next.state == window::ready; });
+                    }
+                    std::swap(m_cur, m_next);
+                    m_next.state = window::idle;
+
+                    if (m_cur.error)
+                    {
+                        auto err = std::exchange(m_cur.error, error_code{});
+                        if (m_cur.size == 0)
+                        {
+                            if (done == 0)
+                                set_error_or_throw<io_exception>(ec, err);
+                            else
+                                m_deferred_error = err;
+                            break;
+                        }
+                        m_deferred_error = err;
+                    }
+                    if (m_cur.size == 0)
+                        break; // end of device
+                }
+
+                auto first = std::size_t(pos - m_cur.begin);
+                auto n = std::min(buf.size() - done, m_cur.size - first);
+                std::memcpy(buf.data() + done, m_cur.data.get() + first, n);
+                done += n;
+
+                // keep the following window in flight unless this one reached the end
+                if (m_next.state == window::idle && m_cur.size == m_cur.want && !m_deferred_error)
+                    request(m_cur.begin + m_cur.size);
+            }
+            return done;
+        }
+
+        void request(long_size_t off)
+        {
+            if (m_next.capacity < m_window)
+            {
+                m_next.data = std::make_unique_for_overwrite<std::byte[]>(m_window);
+                m_next.capacity = m_window;
+            }
+            m_next.begin = off;
+            m_next.want = m_window;
+            m_next.size = 0;
+            m_next.error.clear();
+            m_next.state = window::pending;
+            m_cv.notify_all();
+        }
+
+        void run()
+        {
+            std::unique_lock lk(m_mutex);
+            for (;;)
+            {
+                m_cv.wait(lk, [this] { return m_stop || m_next.state == window::pending; });
+                if (m_stop)
+                    return;
+                m_next.state = window::filling;
+                auto begin = m_next.begin;
+                mutable_buffer buf{m_next.data.get(), m_next.want};
+                lk.unlock();
+
+                error_code err;
+                auto n = fill(begin, buf, error_code_ptr(&err));
+
+                lk.lock();
+                m_next.size = n;
+                m_next.error = err;
+                m_next.state = window::ready;
+                ++m_stats.fetches;
+                m_cv.notify_all();
+            }
+        }
+
+        std::size_t fill(long_size_t off, mutable_buffer buf, error_code_ptr ec)
+        {
+            std::size_t n = 0;
+            bool positional = false;
+            if constexpr (positional_reader<Device>)
+                positional = io::supports(m_device, device_caps::positional_reader);
+            if constexpr (random<Device>)
+            {
+                if (!positional)
+                {
+                    io::seek(m_device, off, ec);
+                    if (has_error(ec))
+                        return 0;
+                }
+            }
+            while (n < buf.size())
+            {
+                mutable_buffer got;
+                if constexpr (positional_reader<Device>)
+                    got = positional ? io::read_at(m_device, off + n, buf.subspan(n), ec)
+                                     : io::read(m_device, buf.subspan(n), ec);
+                else
+                    got = io::read(m_device, buf.subspan(n), ec);
+                if (has_error(ec) || got.empty())
+                    break;
+                n += got.size();
+            }
+            return n;
+        }
+
+        Device &m_device;
+        std::size_t m_min_window;
+        std::size_t m_max_window;
+        std::size_t m_window;
+        unsigned m_trigger;
+        unsigned m_streak{0};
+        long_size_t m_pos{0};
+        long_size_t m_last_end{0};
+        error_code m_deferred_error;
+        readahead_stats m_stats;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        window m_cur;  // consumed by read
+        window m_next; // filled by the worker
+        bool m_stop{false};
+        std::thread m_worker;
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_READAHEAD_H
@@ -0,0 +1,267 @@
+#pragma once
+#ifndef APE_ESTL_IO_SPARSE_H
+#define APE_ESTL_IO_SPARSE_H
+#include <ape/estl/io/iocore.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+BEGIN_APE_NAMESPACE
+namespace io
+{
+    // In memory device of any size, storage is allocated a page at a time on first write.
+    // Pages are found through a two level table: a directory of leaves, each leaf mapping
+    // leaf_pages consecutive pages. Unwritten ranges read as zeros, find_data/find_hole
+    // let consumers skip them without reading, punch_hole frees pages again.
+    // imp [ sequence, forward, random ]
+    //     [ reader, positional_reader, is_eofer, sizer ]
+    //     [ writer, positional_writer, syncer, truncater ]
+    //     [ extent_finder, hole_puncher ]
+    class sparse_memory_device
+    {
+    public:
+        static constexpr std::size_t default_page_size = 64 * 1024;
+        static constexpr std::size_t leaf_pages = 1024;
+
+        explicit sparse_memory_device(std::size_t page_size = default_page_size)
+            : m_page_size(std::max<std::size_t>(page_size, 1)) {}
+
+        sparse_memory_device(sparse_memory_device &&) noexcept = default;
+        sparse_memory_device &operator=(sparse_memory_device &&) noexcept = default;
+
+        std::size_t page_size() const noexcept { return m_page_size; }
+        std::size_t get_option(block_size_option) const noexcept { return m_page_size; }
+        // number of allocated pages, memory use is proportional to it
+        std::size_t page_count() const noexcept { return m_pages; }
+
+        long_size_t offset(error_code_ptr ec = {}) const noexcept
+        { // sequence
+            clear_error(ec);
+            return m_pos;
+        }
+
+        long_size_t seek(long_size_t offset, error_code_ptr ec = {}) noexcept
+        { // random
+            clear_error(ec);
+            return m_pos = offset;
+        }
+
+        bool is_eof(error_code_ptr ec = {}) const noexcept
+        { // is_eofer
+            clear_error(ec);
+            return m_pos >= m_size;
+        }
+
+        long_size_t size(error_code_ptr ec = {}) const noexcept
+        { // sizer
+            clear_error(ec);
+            return m_size;
+        }
+
+        mutable_buffer read(mutable_buffer buf, error_code_ptr ec = {})
+        { // reader
+            auto res = read_at(m_pos, buf, ec);
+            m_pos += res.size();
+            return res;
+        }
+
+        mutable_buffer read_at(long_size_t off, mutable_buffer buf, error_code_ptr ec = {}) const noexcept
+        { // positional_reader
+            clear_error(ec);
+            if (off >= m_size)
+                return buf.first(0);
+
+            auto n = std::size_t(std::min<long_size_t>(buf.size(), m_size - off));
+            std::size_t done = 0;
+            while (done < n)
+            {
+                auto pos = off + done;
+                auto first = std::size_t(pos % m_page_size);
+                auto len = std::min(n - done, m_page_size - first);
+                if (auto page = find_page(pos / m_page_size))
+                    std::memcpy(buf.data() + done, page + first, len);
+                else
+                    std::memset(buf.data() + done, 0, len);
+                done += len;
+            }
+            return buf.first(n);
+        }
+
+        const_buffer write(const_buffer buf, error_code_ptr ec = {})
+        { // writer
+            auto res = write_at(m_pos, buf, ec);
+            m_pos += buf.size() - res.size();
+            return res;
+        }
+
+        const_buffer write_at(long_size_t off, const_buffer buf, error_code_ptr ec = {})
+        { // positional_writer
+            if (buf.size() > unknown_size - off)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                return buf;
+            }
+            std::size_t done = 0;
+            while (done < buf.size())
+            {
+                auto pos = off + done;
+                auto first = std::size_t(pos % m_page_size);
+                auto len = std::min(buf.size() - done, m_page_size - first);
+                auto page = get_page(pos / m_page_size, len == m_page_size, ec);
+                if (!page)
+                {
+                    m_size = std::max(m_size, long_size_t(pos));
+                    return buf.subspan(done);
+                }
+                std::memcpy(page + first, buf.data() + done, len);
+                done += len;
+            }
+            m_size = std::max(m_size, off + buf.size());
+            clear_error(ec);
+            return buf.last(0);
+        }
+
+        void sync(error_code_ptr ec = {}) const noexcept
+        { // syncer
+            clear_error(ec);
+        }
+
+        long_size_t truncate(long_size_t size, error_code_ptr ec = {})
+        { // truncater
+            if (size < m_size)
+            {
+                // free whole pages past the end, zero the tail of the last kept one so regrowing reads zeros
+                auto keep = (size + m_page_size - 1) / m_page_size;
+                auto last = (m_size + m_page_size - 1) / m_page_size;
+                for (auto idx = keep; idx < last; ++idx)
+                {
+                    if (auto dir = std::size_t(idx / leaf_pages); dir < m_directory.size() && m_directory[dir])
+                    {
+                        auto &slot = (*m_directory[dir])[idx % leaf_pages];
+                        m_pages -= slot != nullptr;
+                        slot.reset();
+                    }
+                    else
+                        idx = (idx / leaf_pages + 1) * leaf_pages - 1; // skip a missing leaf
+                }
+                if (auto tail = std::size_t(size % m_page_size))
+                    if (auto page = find_page(size / m_page_size))
+                        std::memset(page + tail, 0, m_page_size - tail);
+            }
+            m_size = size;
+            clear_error(ec);
+            return size;
+        }
+
+        // first offset at or after off inside an allocated page, size() when there is none
+        long_size_t find_data(long_size_t off, error_code_ptr ec = {}) const noexcept
+        { // extent_finder
+            clear_error(ec);
+            for (auto idx = off / m_page_size; idx * m_page_size < m_size;)
+            {
+                auto dir = std::size_t(idx / leaf_pages);
+                if (dir >= m_directory.size())
+                    break;
+                if (!m_directory[dir])
+                {
+                    idx = (dir + 1) * leaf_pages;
+                    continue;
+                }
+                if ((*m_directory[dir])[idx % leaf_pages])
+                    return std::max(off, idx * m_page_size);
+                ++idx;
+            }
+            return m_size;
+        }
+
+        // first offset at or after off inside an unallocated page or at the end of the device
+        long_size_t find_hole(long_size_t off, error_code_ptr ec = {}) const noexcept
+        { // extent_finder
+            clear_error(ec);
+            for (auto idx = off / m_page_size; idx * m_page_size < m_size; ++idx)
+                if (!find_page(idx))
+                    return std::max(off, idx * m_page_size);
+            return std::max(off, m_size);
+        }
+
+        // pages inside the range are freed, the partly covered ones at its ends zeroed
+        void punch_hole(long_offset_range rng, error_code_ptr ec = {})
+        { // hole_puncher
+            if (!is_valid_range(rng))
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::invalid_argument);
+                return;
+            }
+            auto end = std::min(long_size_t(rng.end), m_size);
+            for (auto pos = find_data(long_size_t(rng.begin)); pos < end; pos = find_data(pos))
+            {
+                auto idx = pos / m_page_size;
+                auto first = std::size_t(pos % m_page_size);
+                auto len = std::size_t(std::min<long_size_t>(end - pos, m_page_size - first));
+                if (len == m_page_size)
+                {
+                    (*m_directory[std::size_t(idx / leaf_pages)])[idx % leaf_pages].reset();
+                    --m_pages;
+                }
+                else
+                    std::memset(find_page(idx) + first, 0, len);
+                pos += len;
+            }
+            clear_error(ec);
+        }
+
+    private:
+        using leaf = std::array<std::unique_ptr<std::byte[]>, leaf_pages>;
+
+        std::byte *find_page(long_size_t idx) const noexcept
+        {
+            auto dir = idx / leaf_pages;
+            if (dir >= m_directory.size() || !m_directory[std::size_t(dir)])
+                return nullptr;
+            return (*m_directory[std::size_t(dir)])[idx % leaf_pages].get();
+        }
+
+        std::byte *get_page(long_size_t idx, bool overwrite, error_code_ptr ec)
+        {
+            auto dir = idx / leaf_pages;
+            try
+            {
+                if (!in_size_t_range(dir + 1))
+                {
+                    set_error_or_throw<io_exception>(ec, std::errc::value_too_large);
+                    return nullptr;
+                }
+                if (dir >= m_directory.size())
+                    m_directory.resize(std::size_t(dir) + 1);
+                auto &l = m_directory[std::size_t(dir)];
+                if (!l)
+                    l = std::make_unique<leaf>();
+                auto &slot = (*l)[idx % leaf_pages];
+                if (!slot)
+                {
+                    // a page written in full needs no zero fill
+                    slot = overwrite ? std::make_unique_for_overwrite<std::byte[]>(m_page_size)
+                                     : std::make_unique<std::byte[]>(m_page_size);
+                    ++m_pages;
+                }
+                return slot.get();
+            }
+            catch (const std::bad_alloc &)
+            {
+                set_error_or_throw<io_exception>(ec, std::errc::not_enough_memory);
+                return nullptr;
+            }
+        }
+
+        std::size_t m_page_size;
+        std::vector<std::unique_ptr<leaf>> m_directory;
+        std::size_t m_pages{0};
+        long_size_t m_size{0};
+        long_size_t m_pos{0};
+    };
+}
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_IO_SPARSE_H
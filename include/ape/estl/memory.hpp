@@ -5,7 +5,9 @@
 #include <memory>   // for std::addressof
 #include <utility> // for std::forward
 #include <iterator> //for forward_iterator
+#include <algorithm>
 #include <array>
+#include <new>
 BEGIN_APE_NAMESPACE
 
 template<typename T> inline constexpr
@@ -92,5 +94,83 @@ struct extra_allocator_traits : AllocTraits
             std::swap(a, b);
     }
 };
+
+/// Allocator adaptor default initializing elements constructed without arguments, so containers
+/// of trivial types (e.g. std::vector<std::byte>) can grow without zero filling.
+template <typename T, typename Alloc = std::allocator<T>>
+class default_init_allocator : public Alloc
+{
+    using traits = std::allocator_traits<Alloc>;
+
+public:
+    template <typename U>
+    struct rebind
+    {
+        using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+    };
+
+    using Alloc::Alloc;
+    default_init_allocator() = default;
+    constexpr default_init_allocator(const Alloc &a) noexcept : Alloc(a) {}
+
+    template <typename U>
+    void construct(U *p) noexcept(std::is_nothrow_default_constructible_v<U>)
+    {
+        ::new (static_cast<void *>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args)
+    {
+        traits::construct(static_cast<Alloc &>(*this), p, std::forward<Args>(args)...);
+    }
+};
+/// Allocator of storage aligned to a power of two chosen at run time, 4096 by default, e.g. for
+/// buffers of direct io. Allocators compare equal when their alignments are equal.
+template <typename T>
+class aligned_allocator
+{
+public:
+    using value_type = T;
+    using is_always_equal = std::false_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static constexpr std::size_t default_alignment = 4096;
+
+    constexpr aligned_allocator() noexcept = default;
+    constexpr explicit aligned_allocator(std::size_t alignment) noexcept
+        : m_alignment(std::max(alignment, alignof(T)))
+    {
+        APE_Expects((alignment & (alignment - 1)) == 0);
+    }
+    template <typename U>
+    constexpr aligned_allocator(const aligned_allocator<U> &rhs) noexcept
+        : m_alignment(std::max(rhs.alignment(), alignof(T)))
+    {
+    }
+
+    constexpr std::size_t alignment() const noexcept { return m_alignment; }
+
+    [[nodiscard]] T *allocate(std::size_t n)
+    {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(m_alignment)));
+    }
+    void deallocate(T *p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(m_alignment));
+    }
+
+    template <typename U>
+    constexpr bool operator==(const aligned_allocator<U> &rhs) const noexcept
+    {
+        return m_alignment == rhs.alignment();
+    }
+
+private:
+    std::size_t m_alignment{std::max(default_alignment, alignof(T))};
+};
 END_APE_NAMESPACE
 #endif
\ No newline at end of file
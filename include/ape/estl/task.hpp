@@ -0,0 +1,209 @@
+#pragma once
+#ifndef APE_ESTL_TASK_H
+#define APE_ESTL_TASK_H
+#include <ape/config.hpp>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <variant>
+
+BEGIN_APE_NAMESPACE
+namespace detail
+{
+    struct task_promise_base
+    {
+        std::coroutine_handle<> continuation;
+
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+            {
+                auto next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+    };
+
+    template <typename T>
+    struct task_promise : task_promise_base
+    {
+        std::variant<std::monostate, T, std::exception_ptr> result;
+
+        template <typename U>
+        void return_value(U &&v) { result.template emplace<1>(std::forward<U>(v)); }
+        void unhandled_exception() noexcept { result.template emplace<2>(std::current_exception()); }
+
+        T take()
+        {
+            if (result.index() == 2)
+                std::rethrow_exception(std::get<2>(result));
+            return std::move(std::get<1>(result));
+        }
+    };
+
+    template <>
+    struct task_promise<void> : task_promise_base
+    {
+        std::exception_ptr error;
+
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        void take()
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+}
+
+/// Lazy coroutine, starts when awaited and resumes the awaiting coroutine when done.
+template <typename T = void>
+class task
+{
+public:
+    struct promise_type : detail::task_promise<T>
+    {
+        task get_return_object() noexcept
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    task(task &&rhs) noexcept : m_coro(std::exchange(rhs.m_coro, {})) {}
+    task &operator=(task &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (m_coro)
+                m_coro.destroy();
+            m_coro = std::exchange(rhs.m_coro, {});
+        }
+        return *this;
+    }
+    ~task()
+    {
+        if (m_coro)
+            m_coro.destroy();
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct awaiter
+        {
+            std::coroutine_handle<promise_type> coro;
+
+            bool await_ready() const noexcept { return !coro || coro.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                coro.promise().continuation = awaiting;
+                return coro;
+            }
+            T await_resume() { return coro.promise().take(); }
+        };
+        return awaiter{m_coro};
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> h) noexcept : m_coro(h) {}
+
+    std::coroutine_handle<promise_type> m_coro;
+};
+
+/// Run queue drained by the thread calling run(). post() may be called from any thread,
+/// so work offloaded to other threads can resume its coroutine back on the scheduler.
+class single_thread_scheduler
+{
+public:
+    void post(std::function<void()> fn)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back(std::move(fn));
+        }
+        m_ready.notify_one();
+    }
+
+    /// co_await scheduler.schedule() continues the coroutine on the scheduler thread
+    auto schedule() noexcept
+    {
+        struct awaiter
+        {
+            single_thread_scheduler *self;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { self->post([h] { h.resume(); }); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{this};
+    }
+
+    /// start t on the next run(), exceptions escaping t terminate the program
+    void spawn(task<void> t)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            ++m_active;
+        }
+        post([this, t = std::make_shared<task<void>>(std::move(t))]() mutable { drive(std::move(*t)); });
+    }
+
+    /// process posted work until every spawned task is finished
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> fn;
+            {
+                std::unique_lock lock(m_mutex);
+                m_ready.wait(lock, [this] { return !m_queue.empty() || m_active == 0; });
+                if (m_queue.empty())
+                    return;
+                fn = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            fn();
+        }
+    }
+
+private:
+    struct detached
+    {
+        struct promise_type
+        {
+            detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    detached drive(task<void> t)
+    {
+        co_await std::move(t);
+        {
+            std::lock_guard lock(m_mutex);
+            --m_active;
+        }
+        m_ready.notify_one();
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<std::function<void()>> m_queue;
+    std::size_t m_active{0};
+};
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_TASK_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef APE_ESTL_THREAD_POOL_H
+#define APE_ESTL_THREAD_POOL_H
+#include <ape/config.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_APE_NAMESPACE
+
+/// Fixed size pool of worker threads running posted tasks in FIFO order.
+/// The destructor runs all tasks already posted, then joins the workers.
+class thread_pool
+{
+public:
+    explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        m_workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+            m_workers.emplace_back([this] { run(); });
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_all();
+        for (auto &t : m_workers)
+            t.join();
+    }
+
+    std::size_t size() const noexcept { return m_workers.size(); }
+
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_ready.notify_one();
+    }
+
+private:
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_ready.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping{false};
+    std::vector<std::thread> m_workers;
+};
+
+END_APE_NAMESPACE
+#endif // end APE_ESTL_THREAD_POOL_H
@@ -6,6 +6,7 @@
 #include <gsl/gsl_assert>
 
 #include <cstdint>
+#include <limits>
 
 BEGIN_APE_NAMESPACE
 template <typename... Args> void unused(Args &&...) {}
@@ -0,0 +1,29 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/backports/expected.hpp>
+#include <string>
+
+TEST_CASE( "test expected", "[expected.default]" ) {
+    using ape::stl::expected;
+    using ape::stl::unexpected;
+
+    expected<int, std::string> value(42);
+    CHECK(value.has_value());
+    CHECK(*value == 42);
+    CHECK(value.value_or(0) == 42);
+
+    expected<int, std::string> error = unexpected(std::string("failed"));
+    CHECK(!error);
+    CHECK(error.error() == "failed");
+    CHECK(error.value_or(7) == 7);
+    CHECK_THROWS_AS(error.value(), ape::stl::bad_expected_access<std::string>);
+
+    auto copy = error;
+    CHECK(copy.error() == "failed");
+    copy = value;
+    CHECK(*copy == 42);
+
+    expected<void, int> ok;
+    CHECK(ok);
+    expected<void, int> bad = unexpected(3);
+    CHECK(bad.error() == 3);
+}
@@ -28,3 +28,586 @@ TEST_CASE( "test case for io memory device", "[io][memory]" ) {
     REQUIRE(device.size() == 100);
 }
 
+
+TEST_CASE( "test case for io vectored read and write", "[io][vec]" ) {
+    using namespace ape::io;
+    static_assert(vec_reader<memory_device<>> && vec_writer<memory_device<>>);
+    static_assert(vec_reader<zero> && vec_reader<fill> && vec_writer<null>);
+    static_assert(vec_reader<empty>); // generic fallback
+
+    std::vector<std::byte> head(4, std::byte{1}), body(12, std::byte{2});
+    const_buffer out[] = {head, body};
+
+    memory_device<> device;
+    REQUIRE(write_vec(device, out) == 16);
+    REQUIRE(device.size() == 16);
+    REQUIRE(device.offset() == 16);
+
+    std::vector<std::byte> a(8), b(16);
+    mutable_buffer in[] = {a, b};
+    REQUIRE(device.seek(0) == 0);
+    REQUIRE(read_vec(device, in) == 16);
+    REQUIRE(a[3] == std::byte{1});
+    REQUIRE(a[4] == std::byte{2});
+    REQUIRE(b[7] == std::byte{2});
+    REQUIRE(device.is_eof());
+
+    null sink;
+    REQUIRE(write_vec(sink, out) == 16);
+    REQUIRE(sink.offset() == 16);
+
+    zero source;
+    REQUIRE(read_vec(source, in) == 24);
+    REQUIRE(a[0] == std::byte{0});
+    REQUIRE(source.offset() == 24);
+
+    empty nothing;
+    REQUIRE(read_vec(nothing, in) == 0);
+}
+
+TEST_CASE( "test case for io positional read and write", "[io][positional]" ) {
+    using namespace ape::io;
+    static_assert(positional_reader<memory_device<>> && positional_writer<memory_device<>>);
+
+    memory_device<> device;
+    std::vector<std::byte> data(16);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = std::byte(i);
+
+    REQUIRE(device.write_at(4, data).empty());
+    REQUIRE(device.size() == 20);
+    REQUIRE(device.offset() == 0);
+
+    std::vector<std::byte> readin(8);
+    REQUIRE(device.read_at(16, readin).size() == 4);
+    REQUIRE(readin[0] == std::byte{12});
+    REQUIRE(device.read_at(20, readin).empty());
+    REQUIRE(device.offset() == 0);
+
+    multiplex_device<memory_device<>> first(device), second(device, 10);
+    REQUIRE(first.read(readin).size() == 8);
+    REQUIRE(readin[4] == std::byte{0});
+    REQUIRE(second.read(readin).size() == 8);
+    REQUIRE(readin[0] == std::byte{6});
+    REQUIRE(first.offset() == 8);
+    REQUIRE(second.offset() == 18);
+    REQUIRE(device.offset() == 0);
+
+    REQUIRE(second.write(data).empty());
+    REQUIRE(second.offset() == 34);
+    REQUIRE(device.size() == 34);
+    REQUIRE(!first.is_eof());
+    REQUIRE(second.is_eof());
+
+    // without positional io every operation goes through the shared offset
+    zero source;
+    multiplex_device<zero> tracked(source, 4);
+    REQUIRE(tracked.read(readin).size() == 8);
+    REQUIRE(tracked.offset() == 12);
+    REQUIRE(tracked.seek(2) == 2);
+    REQUIRE(tracked.offset() == 2);
+}
+
+TEST_CASE( "test case for io reader_to_view", "[io][view]" ) {
+    using namespace ape::io;
+    memory_device<> device;
+    std::byte data[64];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+    device.write(data);
+
+    reader_to_view<memory_device<>> viewer(device);
+    STATIC_REQUIRE(read_map<decltype(viewer)>);
+    const std::byte* storage = nullptr;
+    {
+        auto v = viewer.view_rd({10, 20});
+        auto a = address(v);
+        REQUIRE(a.size() == 10);
+        REQUIRE(a[0] == std::byte{10});
+        REQUIRE(a[9] == std::byte{19});
+        storage = a.data();
+        REQUIRE(viewer.pool().free_count() == 0);
+    }
+    REQUIRE(viewer.pool().free_count() == 1);
+
+    // the storage of a destroyed view is reused
+    auto v = viewer.view_rd({60, 70});
+    REQUIRE(address(v).data() == storage);
+    REQUIRE(address(v).size() == 4);
+    REQUIRE(address(v)[3] == std::byte{63});
+    REQUIRE(viewer.pool().free_count() == 0);
+}
+
+namespace
+{
+    // memory device recording the size of every write reaching it
+    struct recording_device : ape::io::memory_device<>
+    {
+        std::vector<std::size_t> writes;
+
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            writes.push_back(buf.size());
+            return memory_device::write(buf, ec);
+        }
+        ape::io::const_buffer write_at(ape::long_size_t off, ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            writes.push_back(buf.size());
+            return memory_device::write_at(off, buf, ec);
+        }
+    };
+}
+
+TEST_CASE( "test case for io writer_to_view dirty ranges", "[io][view]" ) {
+    using namespace ape::io;
+    recording_device device;
+    std::byte data[64];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+    device.write(data);
+    device.writes.clear();
+
+    {
+        writer_to_view<recording_device> viewer(device);
+        STATIC_REQUIRE(write_map<decltype(viewer)>);
+
+        {
+            auto v = viewer.view_wr({8, 24});
+            REQUIRE(v.data()[0] == std::byte{8});
+            v.modify(2, 2)[0] = std::byte{0xaa};
+            v.modify(4, 1)[0] = std::byte{0xbb};
+            v.mark_dirty(3, 5);
+            REQUIRE(v.dirty_bytes() == 3);
+        }
+        // a view staged nothing to the device yet, and an untouched view stages nothing
+        REQUIRE(device.writes.empty());
+        REQUIRE(viewer.pending_writes() == 1);
+        {
+            auto v = viewer.view_wr({0, 8});
+        }
+        REQUIRE(viewer.pending_writes() == 1);
+
+        // adjacent to the pending range [10, 13), merged with it
+        {
+            auto v = viewer.view_wr({13, 20});
+            REQUIRE(v.data()[0] == std::byte{8 + 5});
+            v.modify(0, 1)[0] = std::byte{0xcc};
+        }
+        REQUIRE(viewer.pending_writes() == 1);
+        REQUIRE(viewer.pending_bytes() == 4);
+
+        // views see pending data
+        {
+            auto v = viewer.view_wr({10, 14});
+            REQUIRE(v.data()[0] == std::byte{0xaa});
+            REQUIRE(v.data()[3] == std::byte{0xcc});
+        }
+
+        // a disjoint range stays separate, growing the device
+        viewer.view_wr({60, 70}).address()[9] = std::byte{0xdd};
+        REQUIRE(viewer.pending_writes() == 2);
+        REQUIRE(viewer.size() == 70);
+
+        // an explicit release stages the dirty ranges at once and detaches the view
+        auto early = viewer.view_wr({40, 44});
+        early.modify(0, 2)[1] = std::byte{0xee};
+        ape::error_code ec;
+        early.release(ape::error_code_ptr(&ec));
+        REQUIRE(!ec);
+        REQUIRE(viewer.pending_writes() == 3);
+        early.release();
+
+        viewer.sync();
+        REQUIRE(viewer.pending_writes() == 0);
+        REQUIRE((device.writes == std::vector<std::size_t>{4, 2, 10}));
+    }
+
+    std::byte readin[70];
+    device.seek(0);
+    REQUIRE(device.read(readin).size() == 70);
+    REQUIRE(readin[9] == std::byte{9});
+    REQUIRE(readin[10] == std::byte{0xaa});
+    REQUIRE(readin[11] == std::byte{11});
+    REQUIRE(readin[12] == std::byte{0xbb});
+    REQUIRE(readin[13] == std::byte{0xcc});
+    REQUIRE(readin[14] == std::byte{14});
+    REQUIRE(readin[41] == std::byte{0xee});
+    REQUIRE(readin[63] == std::byte{63});
+    REQUIRE(readin[64] == std::byte{0});
+    REQUIRE(readin[69] == std::byte{0xdd});
+}
+
+namespace
+{
+    // write-only front of a memory device, views over it cannot read back
+    struct write_only_device
+    {
+        ape::io::memory_device<> target;
+
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            return target.write(buf, ec);
+        }
+        ape::long_size_t seek(ape::long_size_t off, ape::error_code_ptr ec = {})
+        {
+            return target.seek(off, ec);
+        }
+        ape::long_size_t offset(ape::error_code_ptr ec = {}) const
+        {
+            return target.offset(ec);
+        }
+    };
+}
+
+TEST_CASE( "test case for io writer_to_view over a writer only device", "[io][view]" ) {
+    using namespace ape::io;
+    write_only_device device;
+    STATIC_REQUIRE(writer<write_only_device> && !reader<write_only_device>);
+    {
+        writer_to_view<write_only_device> viewer(device);
+        {
+            auto v = viewer.view_wr({0, 8});
+            std::memset(v.address().data(), 0xab, 8);
+        }
+        // reuses the pooled storage of the first view, which must come back zeroed
+        {
+            auto v = viewer.view_wr({32, 40});
+            REQUIRE(v.data()[1] == std::byte{0});
+            v.address()[0] = std::byte{1};
+        }
+        // pending writes are overlaid even though the device cannot be read
+        {
+            auto v = viewer.view_wr({4, 12});
+            REQUIRE(v.data()[0] == std::byte{0xab});
+            REQUIRE(v.data()[4] == std::byte{0});
+        }
+        viewer.flush();
+    }
+
+    std::byte readin[40];
+    device.target.seek(0);
+    REQUIRE(device.target.read(readin).size() == 40);
+    REQUIRE(readin[7] == std::byte{0xab});
+    REQUIRE(readin[8] == std::byte{0});
+    REQUIRE(readin[32] == std::byte{1});
+    for (std::size_t i = 33; i < 40; ++i)
+        REQUIRE(readin[i] == std::byte{0});
+}
+
+namespace
+{
+    // memory device writing at most limit bytes per call, without reporting an error
+    struct trickle_device : ape::io::memory_device<>
+    {
+        std::size_t limit = 3;
+
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            auto n = std::min(limit, buf.size());
+            return memory_device::write(buf.first(n), ec).empty() ? buf.subspan(n) : buf;
+        }
+        ape::io::const_buffer write_at(ape::long_size_t off, ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            auto n = std::min(limit, buf.size());
+            return memory_device::write_at(off, buf.first(n), ec).empty() ? buf.subspan(n) : buf;
+        }
+    };
+}
+
+TEST_CASE( "test case for io writer_to_view over short writes", "[io][view]" ) {
+    using namespace ape::io;
+    trickle_device device;
+    writer_to_view<trickle_device> viewer(device);
+    std::memset(viewer.view_wr({0, 10}).address().data(), 0x5a, 10);
+    viewer.flush();
+    REQUIRE(device.size() == 10);
+    std::byte readin[10];
+    REQUIRE(device.read_at(0, readin).size() == 10);
+    REQUIRE(readin[9] == std::byte{0x5a});
+
+    // a write making no progress fails instead of dropping the data
+    device.limit = 0;
+    viewer.view_wr({2, 4}).address()[0] = std::byte{1};
+    ape::error_code ec;
+    viewer.flush(ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::io_error);
+    REQUIRE(viewer.pending_writes() == 1);
+    device.limit = 3;
+    viewer.flush();
+    REQUIRE(viewer.pending_writes() == 0);
+    REQUIRE(device.read_at(2, readin).size() == 8);
+    REQUIRE(readin[0] == std::byte{1});
+}
+
+TEST_CASE( "test case for io chunked memory device", "[io][memory][chunked]" ) {
+    using namespace ape::io;
+    chunked_buffer_represent represent;
+    represent.chunk_size = 16;
+    memory_device<chunked_buffer_represent> device(std::move(represent));
+    STATIC_REQUIRE(reader<decltype(device)> && writer<decltype(device)> && positional_reader<decltype(device)>);
+    STATIC_REQUIRE(read_map<decltype(device)> && write_map<decltype(device)>);
+
+    std::byte data[40];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.size() == 40);
+    REQUIRE(device.underlying().chunks.size() == 3);
+
+    // growing keeps the bytes already written in place
+    auto first_chunk = device.underlying().chunks[0].get();
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.underlying().chunks[0].get() == first_chunk);
+
+    std::byte readin[40];
+    REQUIRE(device.read_at(10, readin).size() == 40);
+    REQUIRE(readin[0] == std::byte{10});
+    REQUIRE(readin[29] == std::byte{39});
+    REQUIRE(readin[30] == std::byte{0});
+
+    // a view inside one chunk points into it, one crossing chunks is a scatter list
+    auto v = device.view_rd({17, 30});
+    REQUIRE(v.buffers().size() == 1);
+    REQUIRE(v.address().data() == device.underlying().chunks[1].get() + 1);
+    auto cross = device.view_rd({10, 40});
+    REQUIRE(cross.buffers().size() == 3);
+    REQUIRE(cross.address().size() == 30);
+    REQUIRE(cross.address()[29] == std::byte{39});
+
+    {
+        auto w = device.view_wr({14, 18});
+        REQUIRE(w.buffers().size() == 2);
+        w.address()[0] = std::byte{0xaa};
+        w.address()[3] = std::byte{0xbb};
+    }
+    REQUIRE(device.read_at(14, {readin, 4}).size() == 4);
+    REQUIRE(readin[0] == std::byte{0xaa});
+    REQUIRE(readin[1] == std::byte{15});
+    REQUIRE(readin[3] == std::byte{0xbb});
+
+    // holes and truncation read back as zeros
+    device.truncate(20);
+    REQUIRE(device.underlying().chunks.size() == 2);
+    REQUIRE(device.write_at(50, {data, 2}).empty());
+    REQUIRE(device.size() == 52);
+    REQUIRE(device.read_at(18, readin).size() == 34);
+    REQUIRE(readin[1] == std::byte{19});
+    REQUIRE(readin[2] == std::byte{0});
+    REQUIRE(readin[31] == std::byte{0});
+    REQUIRE(readin[33] == std::byte{1});
+}
+
+TEST_CASE( "test case for io memory device growth", "[io][memory][growth]" ) {
+    using namespace ape::io;
+    STATIC_REQUIRE(reservable_represent<vector_buffer_represent>);
+    STATIC_REQUIRE(reservable_represent<default_init_buffer_represent>);
+    STATIC_REQUIRE(std::is_same_v<decltype(vector_buffer_represent::data), std::vector<std::byte>>);
+
+    // a plain byte vector is adopted as before
+    std::vector<std::byte> bytes(4, std::byte{3});
+    memory_device<vector_buffer_represent> adopted(vector_buffer_represent{std::move(bytes)});
+    REQUIRE(adopted.size() == 4);
+    const std::byte five{5};
+    REQUIRE(adopted.write_at(6, {&five, 1}).empty());
+    std::byte gap[3];
+    REQUIRE(adopted.read_at(4, gap).size() == 3);
+    REQUIRE(gap[0] == std::byte{0});
+    REQUIRE(gap[2] == std::byte{5});
+
+    memory_device<> device;
+    device.reserve(100);
+    auto& data = device.underlying().data;
+    REQUIRE(data.capacity() >= 100);
+    auto first = data.data();
+
+    std::byte chunk[10];
+    for (auto& b : chunk)
+        b = std::byte{0xff};
+    for (int i = 0; i < 10; ++i)
+        device.write(chunk);
+    REQUIRE(device.size() == 100);
+    REQUIRE(data.data() == first);
+
+    // appends reallocate a logarithmic number of times
+    std::size_t reallocations = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto before = data.data();
+        device.write(chunk);
+        reallocations += before != data.data();
+    }
+    REQUIRE(reallocations < 30);
+
+    // bytes not written over read back as zeros
+    device.truncate(10);
+    device.truncate(20);
+    REQUIRE(device.write_at(30, {chunk, 1}).empty());
+    std::byte readin[21];
+    REQUIRE(device.read_at(10, readin).size() == 21);
+    for (std::size_t i = 0; i < 20; ++i)
+        REQUIRE(readin[i] == std::byte{0});
+    REQUIRE(readin[20] == std::byte{0xff});
+    REQUIRE(device.view_wr({31, 40}).address()[8] == std::byte{0});
+}
+
+namespace
+{
+    // device with options only through the std::any slow path
+    struct any_option_device : ape::io::zero
+    {
+        std::size_t alignment = 512;
+
+        std::any getopt(int id, const std::any &, ape::error_code_ptr ec = {}) const
+        {
+            ape::clear_error(ec);
+            if (id == ape::io::alignment_option::id)
+                return alignment;
+            return {};
+        }
+        std::any setopt(int id, const std::any &, const std::any &indata, ape::error_code_ptr ec = {})
+        {
+            ape::clear_error(ec);
+            if (id == ape::io::alignment_option::id)
+                alignment = std::any_cast<std::size_t>(indata);
+            return {};
+        }
+    };
+}
+
+TEST_CASE( "test case for io typed options", "[io][options]" ) {
+    using namespace ape::io;
+
+    // defaults resolve at compile time
+    static_assert(get_option<alignment_option>(zero{}) == 1);
+    static_assert(get_option<block_size_option>(zero{}) == block_size_option::default_value);
+    ape::error_code ec;
+    zero z;
+    set_option<block_size_option>(z, 1, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::function_not_supported);
+
+    // members
+    sparse_memory_device sparse(8192);
+    STATIC_REQUIRE((supports_option<sparse_memory_device, block_size_option>));
+    STATIC_REQUIRE((!supports_option<sparse_memory_device, alignment_option>));
+    REQUIRE(get_option<block_size_option>(sparse) == 8192);
+    REQUIRE(get_option<alignment_option>(sparse) == 1);
+
+    // std::any fallback
+    any_option_device device;
+    STATIC_REQUIRE(options<any_option_device&>);
+    REQUIRE(get_option<alignment_option>(device) == 512);
+    REQUIRE(get_option<block_size_option>(device) == block_size_option::default_value);
+    set_option<alignment_option>(device, 4096);
+    REQUIRE(get_option<alignment_option>(device) == 4096);
+}
+
+namespace
+{
+    // reader failing every other call, like a non blocking source
+    struct flaky_device
+    {
+        std::size_t calls = 0;
+
+        ape::io::mutable_buffer read(ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            if (++calls % 2 == 0)
+            {
+                ape::set_error_or_throw<ape::io::io_exception>(ec, std::errc::resource_unavailable_try_again);
+                return buf.first(0);
+            }
+            ape::clear_error(ec);
+            return buf.first(1);
+        }
+    };
+
+    // writer running out of room part way through a write
+    struct short_writer
+    {
+        std::size_t room;
+
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            auto n = std::min(room, buf.size());
+            room -= n;
+            if (n < buf.size())
+                ape::set_error_or_throw<ape::io::io_exception>(ec, std::errc::no_space_on_device);
+            else
+                ape::clear_error(ec);
+            return buf.subspan(n);
+        }
+    };
+}
+
+TEST_CASE( "test case for io result returning calls", "[io][result]" ) {
+    using namespace ape::io;
+    memory_device<> device;
+    std::byte data[4] = {};
+
+    auto w = try_write(device, data);
+    REQUIRE(w.has_value());
+    REQUIRE(w->empty());
+    auto s = try_seek(device, 1);
+    REQUIRE(s);
+    REQUIRE(*s == 1);
+    auto r = try_read(device, data);
+    REQUIRE(r);
+    REQUIRE(r->size() == 3);
+
+    flaky_device flaky;
+    REQUIRE(try_read(flaky, data));
+    auto failed = try_read(flaky, data);
+    REQUIRE(!failed);
+    REQUIRE(failed.error().error == std::errc::resource_unavailable_try_again);
+    REQUIRE(failed.error().value.empty());
+    REQUIRE(failed.value_or(mutable_buffer{}).empty());
+
+    // the bytes written before an error are reported with it
+    short_writer full{2};
+    auto partial = try_write(full, data);
+    REQUIRE(!partial);
+    REQUIRE(partial.error().error == std::errc::no_space_on_device);
+    REQUIRE(partial.error().value.size() == 2);
+    REQUIRE(partial.error().value.data() == data + 2);
+}
+
+TEST_CASE( "test case for io error modes benchmark", "[!benchmark][io.result.benchmark]" ) {
+    using namespace ape::io;
+    std::byte data[4] = {};
+
+    BENCHMARK("error_code_ptr") {
+        flaky_device flaky;
+        ape::error_code ec;
+        std::size_t errors = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            flaky.read(data, ape::error_code_ptr(&ec));
+            errors += bool(ec);
+        }
+        return errors;
+    };
+
+    BENCHMARK("exception") {
+        flaky_device flaky;
+        std::size_t errors = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            try
+            {
+                flaky.read(data);
+            }
+            catch (const io_exception&)
+            {
+                ++errors;
+            }
+        }
+        return errors;
+    };
+
+    BENCHMARK("try_read") {
+        flaky_device flaky;
+        std::size_t errors = 0;
+        for (int i = 0; i < 1000; ++i)
+            errors += !try_read(flaky, data);
+        return errors;
+    };
+}
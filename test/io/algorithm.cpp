@@ -0,0 +1,331 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <vector>
+
+namespace
+{
+    std::vector<std::byte> make_pattern(std::size_t n)
+    {
+        std::vector<std::byte> data(n);
+        for (std::size_t i = 0; i < n; ++i)
+            data[i] = std::byte(i % 251);
+        return data;
+    }
+
+    template <typename Device>
+    std::vector<std::byte> read_back(Device &device, std::size_t n)
+    {
+        std::vector<std::byte> res(n);
+        res.resize(ape::io::read_at(device, 0, ape::io::mutable_buffer(res)).size());
+        return res;
+    }
+}
+
+TEST_CASE("test case for io copy between memory devices", "[io][copy]")
+{
+    using namespace ape::io;
+    auto data = make_pattern(1000);
+    memory_device<> src, dst;
+    src.write(data);
+
+    // both map, copied through views
+    REQUIRE(copy(src, dst, {100, 600}) == 500);
+    REQUIRE(dst.offset() == 500);
+    REQUIRE(copy(src, dst, {900, unknown_offset}) == 100);
+    REQUIRE(dst.size() == 600);
+    auto out = read_back(dst, 600);
+    REQUIRE(out[0] == std::byte(100));
+    REQUIRE(out[499] == std::byte(599 % 251));
+    REQUIRE(out[500] == std::byte(900 % 251));
+
+    // a range past the end of src stops there
+    ape::error_code ec;
+    REQUIRE(copy(src, dst, {900, 1100}, ape::error_code_ptr(&ec)) == 100);
+    REQUIRE(!ec);
+    REQUIRE(dst.size() == 700);
+    REQUIRE(copy(src, dst, {1000, 1100}) == 0);
+
+    // onto itself past its end, growing the storage the source is read from
+    memory_device<> self;
+    self.write(make_pattern(100));
+    REQUIRE(copy(self, self, {0, 100}) == 100);
+    REQUIRE(self.size() == 200);
+    auto doubled = read_back(self, 200);
+    REQUIRE(std::equal(doubled.begin(), doubled.begin() + 100, doubled.begin() + 100));
+    REQUIRE(doubled[199] == std::byte(99));
+
+    // src is not a map, copied through a small bounce buffer
+    const std::byte pattern[] = {std::byte{7}};
+    fill filler(pattern);
+    std::byte bounce[16];
+    dst.seek(0);
+    REQUIRE(copy(filler, dst, {0, 100}, bounce) == 100);
+    REQUIRE(read_back(dst, 100)[99] == std::byte{7});
+}
+
+TEST_CASE("test case for io read_ranges", "[io][read_ranges]")
+{
+    using namespace ape::io;
+    auto data = make_pattern(100000);
+
+    // no views, every read_at is one device operation
+    struct counting_device : memory_device<>
+    {
+        std::size_t reads = 0;
+        mutable_buffer read_at(ape::long_size_t off, mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            ++reads;
+            return memory_device<>::read_at(off, buf, ec);
+        }
+        void view_rd(ape::long_offset_range, ape::error_code_ptr = {}) = delete;
+    };
+    static_assert(!read_map<counting_device> && positional_reader<counting_device>);
+
+    counting_device dev;
+    dev.write(data);
+
+    // unsorted, two of them overlap, the last one crosses the end of device
+    const ape::long_offset_range ranges[] = {{4000, 4100}, {100, 200}, {300, 350}, {120, 180}, {60000, 60010}, {99990, 100100}};
+    std::byte storage[6][200];
+    mutable_buffer bufs[6];
+    for (std::size_t i = 0; i < 6; ++i)
+        bufs[i] = storage[i];
+
+    std::byte bounce[8192];
+    REQUIRE(read_ranges(dev, ranges, bufs, 4096, bounce) == 100 + 100 + 50 + 60 + 10 + 10);
+    // [100, 4100) in one read, 60000 alone, 99990 alone and a second read to see the end of device
+    REQUIRE(dev.reads == 4);
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        auto expect = std::min<std::size_t>(ape::size(ranges[i]), data.size() - std::size_t(ranges[i].begin));
+        REQUIRE(bufs[i].size() == expect);
+        REQUIRE(std::equal(bufs[i].begin(), bufs[i].end(), data.begin() + ranges[i].begin));
+    }
+
+    // without merging, one read per range
+    dev.reads = 0;
+    for (std::size_t i = 0; i < 6; ++i)
+        bufs[i] = storage[i];
+    std::byte small[64];
+    REQUIRE(read_ranges(dev, ranges, bufs, 0, small) == 330);
+    REQUIRE(dev.reads == 7);
+
+    // memory devices are copied out of views
+    memory_device<> mem;
+    mem.write(data);
+    for (std::size_t i = 0; i < 6; ++i)
+        bufs[i] = storage[i];
+    REQUIRE(read_ranges(mem, ranges, bufs) == 330);
+    REQUIRE(std::equal(bufs[5].begin(), bufs[5].end(), data.begin() + 99990));
+}
+
+TEST_CASE("test case for io sparse_copy between sparse memory devices", "[io][sparse_copy]")
+{
+    using namespace ape::io;
+    const ape::long_size_t far = 10ull << 30;
+    auto data = make_pattern(10000);
+    sparse_memory_device src(4096), dst(4096);
+    src.write_at(100, data);
+    src.write_at(far, data);
+    // an allocated page of zeros is not copied
+    std::vector<std::byte> zeros(4096);
+    src.write_at(8 * 4096, zeros);
+    REQUIRE(src.page_count() == 7);
+
+    // dst contents are replaced
+    dst.write_at(far / 2, data);
+    REQUIRE(sparse_copy(src, dst) == 12288 + data.size()); // extents are whole pages but for the last one
+    REQUIRE(dst.size() == src.size());
+    REQUIRE(dst.page_count() == 6);
+    REQUIRE(dst.find_data(far / 2) == far);
+
+    std::vector<std::byte> out(10100);
+    REQUIRE(dst.read_at(0, out).size() == out.size());
+    REQUIRE(std::equal(data.begin(), data.end(), out.begin() + 100));
+    REQUIRE(dst.read_at(far, out).size() == data.size());
+    REQUIRE(std::equal(data.begin(), data.end(), out.begin()));
+
+    // an empty source empties dst
+    sparse_memory_device empty;
+    REQUIRE(sparse_copy(empty, dst) == 0);
+    REQUIRE(dst.size() == 0);
+    REQUIRE(dst.page_count() == 0);
+}
+
+#if __has_include(<unistd.h>)
+#include <filesystem>
+#include <string>
+
+namespace
+{
+    struct temp_path
+    {
+        std::string path;
+        explicit temp_path(const char *name)
+            : path((std::filesystem::temp_directory_path() /
+                    (std::string("ape_estl_") + name + "_" + std::to_string(::getpid())))
+                       .string())
+        {
+            std::filesystem::remove(path);
+        }
+        ~temp_path()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    };
+
+    // hides native_handle(), so io::copy goes through the bounce buffer
+    struct plain_file : ape::io::file_device
+    {
+        using file_device::file_device;
+        int native_handle() const = delete;
+    };
+}
+
+TEST_CASE("test case for io copy between files", "[io][copy]")
+{
+    using namespace ape::io;
+    static_assert(native_file<file_device> && !native_file<plain_file>);
+    static_assert(!native_file<mapped_file_device>);
+
+    temp_path src_path("copy_src"), dst_path("copy_dst");
+    auto data = make_pattern(300000);
+    file_device src(src_path.path, open_mode::read_write | open_mode::create);
+    src.write(data);
+
+    {
+        file_device dst(dst_path.path, open_mode::read_write | open_mode::create);
+        dst.seek(10);
+        REQUIRE(copy(src, dst, {0, unknown_offset}) == data.size());
+        REQUIRE(dst.offset() == data.size() + 10);
+        auto out = read_back(dst, data.size() + 10);
+        REQUIRE(std::equal(data.begin(), data.end(), out.begin() + 10));
+    }
+    {
+        plain_file dst(dst_path.path.c_str(), open_mode::read_write | open_mode::truncate);
+        REQUIRE(copy(src, dst, {5, 200005}) == 200000);
+        auto out = read_back(dst, 200000);
+        REQUIRE(std::equal(data.begin() + 5, data.begin() + 200005, out.begin()));
+    }
+    {
+        // the loop stops at the end of src as the views path does
+        memory_device<> dst;
+        ape::error_code ec;
+        REQUIRE(copy(src, dst, {ape::long_offset_t(data.size() - 10), ape::long_offset_t(data.size() + 100)},
+                     ape::error_code_ptr(&ec)) == 10);
+        REQUIRE(!ec);
+        REQUIRE(dst.size() == 10);
+    }
+    {
+        // the kernel must not write behind the mapping, the device would not see the data
+        mapped_file_device dst(dst_path.path, open_mode::read_write | open_mode::truncate);
+        REQUIRE(copy(src, dst, {0, 5000}) == 5000);
+        REQUIRE(dst.size() == 5000);
+        auto out = read_back(dst, 5000);
+        REQUIRE(out.size() == 5000);
+        REQUIRE(std::equal(out.begin(), out.end(), data.begin()));
+    }
+    {
+        mapped_file_device dst(dst_path.path, open_mode::read_write | open_mode::truncate);
+        memory_device<> mem;
+        mem.write(data);
+        REQUIRE(copy(mem, dst, {0, 1000}) == 1000);
+        REQUIRE(dst.size() == 1000);
+        REQUIRE(read_back(dst, 1000)[999] == data[999]);
+    }
+}
+
+TEST_CASE("test case for io sparse_copy between files", "[io][sparse_copy]")
+{
+    using namespace ape::io;
+    temp_path src_path("sparse_copy_src"), dst_path("sparse_copy_dst");
+    auto data = make_pattern(100000);
+    const ape::long_size_t far = 1ull << 30;
+    file_device src(src_path.path, open_mode::read_write | open_mode::create);
+    src.write_at(4096, data);
+    src.write_at(far, data);
+    auto allocated = [](const std::string &path) {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0 ? ape::long_size_t(st.st_blocks) * 512 : unknown_size;
+    };
+
+    auto check = [&](auto &dst) {
+        REQUIRE(dst.size() == far + data.size());
+        std::vector<std::byte> out(data.size());
+        REQUIRE(dst.read_at(4096, out).size() == out.size());
+        REQUIRE(out == data);
+        REQUIRE(dst.read_at(far, out).size() == out.size());
+        REQUIRE(out == data);
+        REQUIRE(dst.read_at(far / 2, {out.data(), 10}).size() == 10);
+        REQUIRE(out[0] == std::byte{0});
+        REQUIRE(allocated(dst_path.path) < 1024 * 1024);
+    };
+    {
+        // copy_file_range writes the data extents whole, their zero tails are counted
+        ape::long_size_t extents = 0;
+        for (auto pos = src.find_data(0); pos < src.size(); pos = src.find_data(pos))
+        {
+            auto hole = src.find_hole(pos);
+            extents += hole - pos;
+            pos = hole;
+        }
+        file_device dst(dst_path.path, open_mode::read_write | open_mode::create);
+        REQUIRE(sparse_copy(src, dst) == extents);
+        check(dst);
+    }
+    {
+        plain_file dst(dst_path.path.c_str(), open_mode::read_write);
+        REQUIRE(sparse_copy(src, dst) >= 2 * data.size()); // extents are rounded to file system blocks
+        check(dst);
+    }
+}
+
+TEST_CASE("test case for io copy benchmark", "[!benchmark][io.copy.benchmark]")
+{
+    using namespace ape::io;
+    constexpr std::size_t size = 16 * 1024 * 1024;
+    temp_path src_path("copy_bench_src"), dst_path("copy_bench_dst");
+    auto data = make_pattern(size);
+    {
+        file_device src(src_path.path, open_mode::write | open_mode::create);
+        src.write(data);
+    }
+
+    memory_device<> mem_src, mem_dst;
+    mem_src.write(data);
+    BENCHMARK("views memory_device -> memory_device")
+    {
+        mem_dst.seek(0);
+        return copy(mem_src, mem_dst, {0, ape::long_offset_t(size)});
+    };
+
+    {
+        file_device src(src_path.path, open_mode::read);
+        file_device dst(dst_path.path, open_mode::write | open_mode::create | open_mode::truncate);
+        BENCHMARK("kernel file_device -> file_device")
+        {
+            dst.seek(0);
+            return copy(src, dst, {0, ape::long_offset_t(size)});
+        };
+    }
+    {
+        plain_file src(src_path.path.c_str(), open_mode::read);
+        plain_file dst(dst_path.path.c_str(), open_mode::write | open_mode::truncate);
+        BENCHMARK("bounce buffer file_device -> file_device")
+        {
+            dst.seek(0);
+            return copy(src, dst, {0, ape::long_offset_t(size)});
+        };
+    }
+    {
+        mapped_file_device src(src_path.path, open_mode::read);
+        mapped_file_device dst(dst_path.path, open_mode::read_write | open_mode::truncate);
+        BENCHMARK("views mapped_file_device -> mapped_file_device")
+        {
+            dst.seek(0);
+            return copy(src, dst, {0, ape::long_offset_t(size)});
+        };
+    }
+}
+#endif
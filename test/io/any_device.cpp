@@ -0,0 +1,250 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace
+{
+    // too large to be stored inline
+    struct big_device : ape::io::zero
+    {
+        std::array<std::byte, 1024> payload{};
+    };
+}
+
+TEST_CASE("test case for io any_device", "[io][any_device]")
+{
+    using namespace ape::io;
+    static_assert(reader<any_device> && writer<any_device> && ape::io::random<any_device>);
+    static_assert(read_map<any_device> && write_map<any_device>);
+    static_assert(any_device::stored_inline<memory_device<>>);
+    static_assert(any_device::stored_inline<shift_device<memory_device<>>>);
+    static_assert(any_device::stored_inline<sub_device<memory_device<>>>);
+    static_assert(!any_device::stored_inline<big_device>);
+
+    any_device empty;
+    REQUIRE(!empty.has_value());
+    ape::error_code ec;
+    empty.offset(ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::function_not_supported);
+
+    any_device device{memory_device<>()};
+    REQUIRE(device.supports(device_caps::reader | device_caps::writer | device_caps::read_map));
+    REQUIRE(device.target<memory_device<>>() != nullptr);
+    REQUIRE(device.target<zero>() == nullptr);
+
+    std::byte data[8] = {std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.offset() == 8);
+    REQUIRE(device.size() == 8);
+    {
+        auto v = device.view_rd({1, 3});
+        REQUIRE(v.address().size() == 2);
+        REQUIRE(v.address()[0] == std::byte{2});
+        auto w = device.view_wr({0, 1});
+        w.address()[0] = std::byte{9};
+    }
+    std::byte readin[8];
+    REQUIRE(device.read_at(0, readin).size() == 8);
+    REQUIRE(readin[0] == std::byte{9});
+
+    // moving relocates the inline device
+    any_device moved(std::move(device));
+    REQUIRE(!device.has_value());
+    REQUIRE(moved.target<memory_device<>>()->size() == 8);
+
+    // adaptors over a device owned elsewhere
+    memory_device<> backing;
+    backing.write(data);
+    any_device shifted{shift_device<memory_device<>>(backing, 4)};
+    REQUIRE(shifted.size() == 4);
+    REQUIRE(shifted.seek(0) == 0);
+    REQUIRE(shifted.read(readin).size() == 4);
+    REQUIRE(readin[0] == std::byte{0});
+
+    // unsupported operations report through the error path
+    any_device source{big_device()};
+    REQUIRE(source.supports(device_caps::reader));
+    REQUIRE(!source.supports(device_caps::writer));
+    REQUIRE(source.read(readin).size() == 8);
+    source.write(data, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::function_not_supported);
+    REQUIRE_THROWS_AS(source.view_rd({0, 1}), io_exception);
+}
+
+namespace
+{
+    // positional source without views, as a file is
+    struct unmapped_device
+    {
+        std::vector<std::byte> data;
+        ape::long_size_t pos = 0;
+
+        ape::io::mutable_buffer read_at(ape::long_size_t off, ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            ape::clear_error(ec);
+            if (off >= data.size())
+                return buf.first(0);
+            auto n = std::min<std::size_t>(buf.size(), data.size() - off);
+            std::copy_n(data.begin() + std::ptrdiff_t(off), n, buf.begin());
+            return buf.first(n);
+        }
+        ape::io::mutable_buffer read(ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            auto res = read_at(pos, buf, ec);
+            pos += res.size();
+            return res;
+        }
+        ape::long_size_t seek(ape::long_size_t off, ape::error_code_ptr ec = {})
+        {
+            ape::clear_error(ec);
+            return pos = off;
+        }
+        ape::long_size_t offset(ape::error_code_ptr ec = {}) const
+        {
+            ape::clear_error(ec);
+            return pos;
+        }
+        ape::long_size_t size(ape::error_code_ptr ec = {}) const
+        {
+            ape::clear_error(ec);
+            return data.size();
+        }
+    };
+}
+
+TEST_CASE("test case for io algorithms over any_device", "[io][any_device]")
+{
+    using namespace ape::io;
+    static_assert(!read_map<unmapped_device>);
+
+    unmapped_device inner;
+    for (std::size_t i = 0; i < 100; ++i)
+        inner.data.push_back(std::byte(i));
+    any_device src{std::move(inner)};
+    REQUIRE(!supports(src, device_caps::read_map));
+    REQUIRE(supports(src, device_caps::positional_reader));
+
+    // any_device models read_map, copy falls back to the loop rather than failing on views
+    memory_device<> dst;
+    ape::error_code ec;
+    REQUIRE(copy(src, dst, {0, unknown_offset}, ape::error_code_ptr(&ec)) == 100);
+    REQUIRE(!ec);
+    REQUIRE(dst.size() == 100);
+    std::byte readin[100];
+    REQUIRE(dst.read_at(0, readin).size() == 100);
+    REQUIRE(readin[99] == std::byte{99});
+
+    // a sequential source without positional io is read from its current offset
+    any_device zeros{zero()};
+    REQUIRE(!supports(zeros, device_caps::positional_reader));
+    REQUIRE(copy(zeros, dst, {0, 8}) == 8);
+    REQUIRE(dst.size() == 108);
+
+    std::byte a[4], b[4];
+    ape::long_offset_range ranges[] = {{90, 94}, {10, 14}};
+    mutable_buffer bufs[] = {a, b};
+    REQUIRE(read_ranges(src, ranges, bufs, 16, impl::copy_bounce_buffer(), ape::error_code_ptr(&ec)) == 8);
+    REQUIRE(!ec);
+    REQUIRE(a[0] == std::byte{90});
+    REQUIRE(b[3] == std::byte{13});
+
+    block_cache_device<any_device> cache(src, 1024, 32, 2);
+    REQUIRE(cache.read_at(40, readin).size() == 60);
+    REQUIRE(readin[0] == std::byte{40});
+}
+
+TEST_CASE("test case for io adaptors over a non positional any_device", "[io][any_device]")
+{
+    using namespace ape::io;
+    memory_device<> backing;
+    std::byte data[64];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+    backing.write(data);
+
+    any_device device{shift_device<memory_device<>>(backing, 8)};
+    REQUIRE(!supports(device, device_caps::positional_reader));
+    REQUIRE(!supports(device, device_caps::positional_writer));
+
+    std::byte readin[8];
+    multiplex_device<any_device> mux(device, 4);
+    REQUIRE(mux.read(readin).size() == 8);
+    REQUIRE(readin[0] == std::byte{12});
+    REQUIRE(mux.offset() == 12);
+    REQUIRE(mux.write({data, 2}).empty());
+    REQUIRE(backing.read_at(20, {readin, 2}).size() == 2);
+    REQUIRE(readin[1] == std::byte{1});
+
+    {
+        writer_to_view<any_device> viewer(device);
+        auto v = viewer.view_wr({0, 8});
+        REQUIRE(v.data()[0] == std::byte{8});
+        v.address()[1] = std::byte{0xee};
+    }
+    REQUIRE(backing.read_at(9, {readin, 1}).size() == 1);
+    REQUIRE(readin[0] == std::byte{0xee});
+
+    reader_to_view<any_device> rd(device);
+    REQUIRE(address(rd.view_rd({2, 6}))[0] == std::byte{10});
+
+    readahead_device<any_device> ahead(device, 16, 32);
+    ahead.seek(0);
+    std::byte all[56];
+    std::size_t got = 0;
+    while (got < sizeof(all))
+    {
+        auto n = ahead.read({all + got, 4}).size();
+        if (n == 0)
+            break;
+        got += n;
+    }
+    REQUIRE(got == 56);
+    REQUIRE(all[55] == std::byte{63});
+}
+
+TEST_CASE("test case for io any_device optional operations", "[io][any_device]")
+{
+    using namespace ape::io;
+    struct aligned_device : memory_device<>
+    {
+        std::size_t get_option(alignment_option) const noexcept { return 512; }
+    };
+    any_device aligned{std::in_place_type<aligned_device>};
+    REQUIRE(get_option<alignment_option>(aligned) == 512);
+    REQUIRE(get_option<block_size_option>(aligned) == block_size_option::default_value);
+    REQUIRE(!aligned.supports(device_caps::extent_finder));
+
+    std::byte data[32];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+    const_buffer out[] = {{data, 8}, {data + 8, 24}};
+    REQUIRE(aligned.write_vec(out) == 32);
+    REQUIRE(aligned.find_data(4) == 4);
+    REQUIRE(aligned.find_hole(4) == 32);
+    aligned.advise({0, 32}, access_pattern::willneed);
+
+    std::byte a[4], b[4];
+    aligned.seek(10);
+    mutable_buffer in[] = {a, b};
+    REQUIRE(aligned.read_vec(in) == 8);
+    REQUIRE(b[3] == std::byte{17});
+
+    any_device sparse{sparse_memory_device(4096)};
+    REQUIRE(sparse.supports(device_caps::extent_finder | device_caps::hole_puncher));
+    REQUIRE(get_option<block_size_option>(sparse) == 4096);
+    sparse.write_at(2 * 4096, data);
+    sparse.write_at(3 * 4096, data);
+    REQUIRE(sparse.find_data(0) == 2 * 4096);
+    REQUIRE(sparse.find_hole(3 * 4096) == sparse.size());
+    sparse.punch_hole({2 * 4096, 3 * 4096});
+    REQUIRE(sparse.find_data(0) == 3 * 4096);
+
+    ape::error_code ec;
+    any_device empty;
+    empty.punch_hole({0, 1}, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::function_not_supported);
+    empty.advise({0, 1}, access_pattern::normal, ape::error_code_ptr(&ec));
+    REQUIRE(!ec);
+}
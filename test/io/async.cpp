@@ -0,0 +1,79 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <ape/estl/task.hpp>
+
+namespace
+{
+    template <typename Device>
+    ape::task<std::size_t> copy_all(Device &src, ape::io::memory_device<> &dst)
+    {
+        std::byte buf[16];
+        std::size_t total = 0;
+        for (;;)
+        {
+            auto [data, ec] = co_await ape::io::async_read(src, buf);
+            if (ec || data.empty())
+                break;
+            total += data.size();
+            dst.write(data);
+        }
+        co_return total;
+    }
+
+    template <typename Device>
+    ape::task<> copy_and_append(Device &src, ape::io::memory_device<> &dst, ape::io::const_buffer extra,
+                                std::size_t &copied, ape::io::async_result<ape::io::const_buffer> &appended)
+    {
+        copied = co_await copy_all(src, dst);
+        appended = co_await ape::io::async_write(ape::io::inline_async(dst), extra);
+    }
+
+    template <typename Device>
+    ape::task<> store_copied(Device &src, ape::io::memory_device<> &dst, std::size_t &copied)
+    {
+        copied = co_await copy_all(src, dst);
+    }
+}
+
+TEST_CASE("test case for io async adaptors", "[io][async]")
+{
+    using namespace ape::io;
+    using inline_type = inline_async<memory_device<>>;
+    using pooled_type = pooled_async<memory_device<>, ape::single_thread_scheduler>;
+    static_assert(async_reader<inline_type> && async_writer<inline_type>);
+    static_assert(async_reader<pooled_type> && async_writer<pooled_type>);
+
+    memory_device<> source;
+    std::vector<std::byte> data(100, std::byte{7});
+    source.write(data);
+
+    ape::single_thread_scheduler scheduler;
+
+    SECTION("inline completion")
+    {
+        source.seek(0);
+        memory_device<> sink;
+        inline_type device(source);
+        std::size_t copied = 0;
+        async_result<const_buffer> appended{data, {}};
+        scheduler.spawn(copy_and_append(device, sink, data, copied, appended));
+        scheduler.run();
+        REQUIRE(copied == 100);
+        REQUIRE(!appended.error);
+        REQUIRE(appended.value.empty());
+        REQUIRE(sink.size() == 200);
+    }
+
+    SECTION("offload to a thread pool, resume on the scheduler")
+    {
+        source.seek(0);
+        memory_device<> sink;
+        ape::thread_pool pool(2);
+        pooled_type device(source, pool, &scheduler);
+        std::size_t copied = 0;
+        scheduler.spawn(store_copied(device, sink, copied));
+        scheduler.run();
+        REQUIRE(copied == 100);
+        REQUIRE(sink.size() == 100);
+    }
+}
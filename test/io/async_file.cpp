@@ -0,0 +1,103 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+
+#if __has_include(<unistd.h>)
+#include <filesystem>
+#include <limits>
+#include <string>
+
+namespace
+{
+    void check_async_device(ape::io::async_backend backend)
+    {
+        using namespace ape::io;
+        auto path = (std::filesystem::temp_directory_path() /
+                     ("ape_estl_async_file_" + std::to_string(::getpid())))
+                        .string();
+
+        ape::error_code ec;
+        async_file_device device(path, open_mode::read_write | open_mode::create | open_mode::truncate,
+                                 backend, ape::error_code_ptr(&ec));
+        if (ec && backend == async_backend::uring)
+            return; // io_uring is not available here
+        REQUIRE(!ec);
+        REQUIRE((backend == async_backend::automatic || device.backend() == backend));
+
+        constexpr std::size_t block = 512, count = 32;
+        std::vector<std::byte> data(block * count);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = std::byte(i / block);
+
+        // synchronous facade
+        REQUIRE(device.write(data).empty());
+        REQUIRE(device.offset() == data.size());
+        REQUIRE(device.size() == data.size());
+
+        // a batch of positional reads, reaped together
+        std::vector<std::byte> readin(data.size());
+        std::vector<completion_token> tokens;
+        for (std::size_t i = 0; i < count; ++i)
+            tokens.push_back(device.submit_read_at(i * block, mutable_buffer(readin).subspan(i * block, block)));
+        REQUIRE(device.in_flight() == count);
+
+        std::vector<completion> done(count);
+        std::size_t reaped = 0;
+        while (reaped < count)
+            reaped += device.wait(std::span(done).subspan(reaped), count - reaped);
+        REQUIRE(device.in_flight() == 0);
+        for (auto &c : done)
+        {
+            REQUIRE(!c.error);
+            REQUIRE(c.bytes == block);
+        }
+        REQUIRE(readin == data);
+
+        // the synchronous facade keeps unrelated completions for wait
+        std::byte one[4];
+        auto token = device.submit_read_at(block, one);
+        REQUIRE(device.seek(0) == 0);
+        std::byte head[8];
+        REQUIRE(device.read(head).size() == 8);
+        REQUIRE(device.wait(std::span(done).first(1)) == 1);
+        REQUIRE(done[0].token == token);
+        REQUIRE(one[0] == std::byte{1});
+
+        std::byte tail[8];
+        REQUIRE(device.read_at(data.size() - 4, tail).size() == 4);
+
+        // a seek out of range fails and keeps the position
+        device.seek(std::numeric_limits<ape::long_size_t>::max(), ape::error_code_ptr(&ec));
+        REQUIRE(ec == std::errc::value_too_large);
+        REQUIRE(device.offset() == 8);
+
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_CASE("test case for io async file device", "[io][async_file]")
+{
+    using namespace ape::io;
+    static_assert(reader<async_file_device> && writer<async_file_device> && ape::io::random<async_file_device>);
+    static_assert(positional_reader<async_file_device> && positional_writer<async_file_device>);
+
+    check_async_device(async_backend::thread_pool);
+    check_async_device(async_backend::uring);
+}
+
+TEST_CASE("test case for io async file device failing to open", "[io][async_file]")
+{
+    using namespace ape::io;
+    auto path = (std::filesystem::temp_directory_path() / "ape_estl_async_file_missing" / "none").string();
+
+    ape::error_code ec;
+    async_file_device device(path, open_mode::read, async_backend::automatic, ape::error_code_ptr(&ec));
+    REQUIRE(ec);
+
+    std::byte buf[16];
+    REQUIRE(device.submit_read_at(0, buf, ape::error_code_ptr(&ec)) == 0);
+    REQUIRE(ec == std::errc::bad_file_descriptor);
+    REQUIRE(device.read_at(0, buf, ape::error_code_ptr(&ec)).empty());
+    REQUIRE(ec);
+    REQUIRE(device.in_flight() == 0);
+}
+#endif
@@ -0,0 +1,167 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+
+namespace
+{
+    // memory device counting the calls reaching it
+    struct counting_device : ape::io::memory_device<>
+    {
+        std::size_t reads = 0;
+        std::size_t writes = 0;
+
+        ape::io::mutable_buffer read(ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            ++reads;
+            return memory_device::read(buf, ec);
+        }
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            ++writes;
+            return memory_device::write(buf, ec);
+        }
+    };
+
+    counting_device make_device(std::size_t n)
+    {
+        counting_device device;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto b = std::byte(i);
+            device.write({&b, 1});
+        }
+        device.seek(0);
+        device.reads = device.writes = 0;
+        return device;
+    }
+}
+
+TEST_CASE("test case for io buffered reader", "[io][buffered]")
+{
+    using namespace ape::io;
+    using reader_type = buffered_reader<counting_device>;
+    static_assert(reader<reader_type> && sequence<reader_type> && forward<reader_type>);
+    static_assert(ape::io::random<reader_type> && sizer<reader_type> && is_eofer<reader_type>);
+
+    auto device = make_device(100);
+    reader_type rd(device, 16);
+
+    std::byte b[4];
+    for (int i = 0; i < 8; ++i)
+        REQUIRE(rd.read(b).size() == 4);
+    REQUIRE(b[3] == std::byte{31});
+    REQUIRE(device.reads == 2);
+    REQUIRE(rd.offset() == 32);
+
+    auto head = rd.peek(6);
+    REQUIRE(head.size() == 6);
+    REQUIRE(head[0] == std::byte{32});
+    REQUIRE(rd.offset() == 32);
+    rd.consume(2);
+    REQUIRE(rd.offset() == 34);
+
+    // larger than the block
+    auto wide = rd.peek(20);
+    REQUIRE(wide.size() == 20);
+    REQUIRE(wide[19] == std::byte{53});
+
+    // backward seek inside the buffer does not reach the device
+    auto reads = device.reads;
+    REQUIRE(rd.seek(36) == 36);
+    REQUIRE(rd.read(b).size() == 4);
+    REQUIRE(b[0] == std::byte{36});
+    REQUIRE(device.reads == reads);
+
+    REQUIRE(rd.seek_forward(90) == 90);
+    std::byte big[64];
+    REQUIRE(rd.read(big).size() == 10);
+    REQUIRE(big[9] == std::byte{99});
+    REQUIRE(rd.is_eof());
+    REQUIRE(rd.peek(1).empty());
+}
+
+TEST_CASE("test case for io buffered writer", "[io][buffered]")
+{
+    using namespace ape::io;
+    using writer_type = buffered_writer<shift_device<counting_device>>;
+    static_assert(writer<writer_type> && syncer<writer_type> && ape::io::random<writer_type>);
+    static_assert(truncater<writer_type> && sizer<writer_type>);
+
+    counting_device device;
+    shift_device<counting_device> shifted(device, 4);
+    {
+        writer_type wr(shifted, 16);
+        std::byte small[5]{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}};
+        for (int i = 0; i < 3; ++i)
+            REQUIRE(wr.write(small).empty());
+        REQUIRE(device.writes == 0);
+        REQUIRE(wr.pending() == 15);
+        REQUIRE(wr.offset() == 15);
+        REQUIRE(wr.size() == 15);
+
+        REQUIRE(wr.write(small).empty()); // overflow flushes the block
+        REQUIRE(device.writes == 1);
+        REQUIRE(wr.pending() == 5);
+
+        std::byte large[32]{};
+        REQUIRE(wr.write(large).empty()); // flush, then write through
+        REQUIRE(device.writes == 3);
+        REQUIRE(wr.pending() == 0);
+        REQUIRE(device.size() == 4 + 52);
+
+        REQUIRE(wr.write(small).empty());
+        REQUIRE(wr.seek(0) == 0); // flushes before moving
+        REQUIRE(device.size() == 4 + 57);
+        REQUIRE(wr.write(small).empty());
+    }
+    // flushed on destruction
+    std::byte readin[5];
+    REQUIRE(device.read_at(4, readin).size() == 5);
+    REQUIRE(readin[4] == std::byte{5});
+    REQUIRE(device.writes == 5);
+}
+
+namespace
+{
+    // memory device failing every write and offset query once broken
+    struct failing_device : ape::io::memory_device<>
+    {
+        bool broken = false;
+
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            if (!broken)
+                return memory_device::write(buf, ec);
+            ape::set_error_or_throw<ape::io::io_exception>(ec, std::errc::no_space_on_device);
+            return buf;
+        }
+        ape::long_size_t offset(ape::error_code_ptr ec = {}) const
+        {
+            if (!broken)
+                return memory_device::offset(ec);
+            ape::set_error_or_throw<ape::io::io_exception>(ec, std::errc::io_error);
+            return 0;
+        }
+    };
+}
+
+TEST_CASE("test case for io buffered writer errors", "[io][buffered]")
+{
+    using namespace ape::io;
+    failing_device device;
+    buffered_writer<failing_device> wr(device, 16);
+    std::byte small[5]{};
+    REQUIRE(wr.write(small).empty());
+    device.broken = true;
+
+    // the flush error is reported, not replaced by the failing offset query
+    ape::error_code ec;
+    REQUIRE(wr.seek(0, ape::error_code_ptr(&ec)) == 0);
+    REQUIRE(ec == std::errc::no_space_on_device);
+    REQUIRE(wr.seek_forward(1, ape::error_code_ptr(&ec)) == 0);
+    REQUIRE(ec == std::errc::no_space_on_device);
+
+    device.broken = false;
+    REQUIRE(wr.seek(2, ape::error_code_ptr(&ec)) == 2);
+    REQUIRE(!ec);
+    REQUIRE(device.size() == 5);
+}
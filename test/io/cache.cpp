@@ -0,0 +1,206 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    ape::io::memory_device<> make_device(std::size_t n)
+    {
+        ape::io::memory_device<> device;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto b = std::byte(i % 251);
+            device.write({&b, 1});
+        }
+        return device;
+    }
+
+    // counts size queries, a syscall on files
+    struct sized_device : ape::io::memory_device<>
+    {
+        mutable int size_calls = 0;
+
+        ape::long_size_t size(ape::error_code_ptr ec = {}) const
+        {
+            ++size_calls;
+            return memory_device::size(ec);
+        }
+    };
+}
+
+TEST_CASE("test case for block cache hits, misses and evictions", "[io.cache]")
+{
+    auto device = make_device(1000);
+    ape::io::block_cache_device cache(device, 4 * 64, 64, 1);
+
+    std::byte buf[256];
+    auto got = cache.read_at(10, {buf, 100});
+    REQUIRE(got.size() == 100);
+    for (std::size_t i = 0; i < got.size(); ++i)
+        REQUIRE(got[i] == std::byte((10 + i) % 251));
+    REQUIRE(cache.stats().misses == 2);
+    REQUIRE(cache.stats().hits == 0);
+
+    cache.read_at(64, {buf, 64});
+    REQUIRE(cache.stats().hits == 1);
+
+    // blocks 2..5 push out blocks 0 and 1
+    cache.read_at(128, {buf, 4 * 64});
+    REQUIRE(cache.stats().misses == 6);
+    REQUIRE(cache.stats().evictions == 2);
+
+    cache.read_at(0, {buf, 1});
+    REQUIRE(cache.stats().misses == 7);
+
+    // short read at the end of the device
+    got = cache.read_at(990, {buf, 100});
+    REQUIRE(got.size() == 10);
+    REQUIRE(got[9] == std::byte(999 % 251));
+    REQUIRE(cache.read_at(1000, buf).empty());
+
+    cache.seek(995);
+    REQUIRE(cache.read(buf).size() == 5);
+    REQUIRE(cache.is_eof());
+}
+
+TEST_CASE("test case for block cache capacity below one block per shard", "[io.cache]")
+{
+    auto device = make_device(1000);
+    // two blocks of capacity over the default 16 shards
+    ape::io::block_cache_device cache(device, 2 * 64, 64);
+
+    std::byte buf[1000];
+    REQUIRE(cache.read_at(0, buf).size() == 1000);
+    auto s = cache.stats();
+    REQUIRE(s.misses == 16);
+    REQUIRE(s.misses - s.evictions == 2);
+
+    // less than a block still caches one
+    ape::io::block_cache_device tiny(device, 10, 64);
+    tiny.read_at(0, {buf, 10});
+    tiny.read_at(0, {buf, 10});
+    REQUIRE(tiny.stats().hits == 1);
+}
+
+TEST_CASE("test case for block cache advise", "[io.cache]")
+{
+    using namespace ape::io;
+    auto device = make_device(1000);
+    block_cache_device cache(device, 16 * 64, 64, 1);
+    static_assert(advisor<block_cache_device<memory_device<>>>);
+    static_assert(!advisor<memory_device<>>);
+    REQUIRE_NOTHROW(advise(device, {0, 10}, access_pattern::willneed)); // no-op by default
+
+    // willneed loads no more than a quarter of the cache
+    cache.advise({0, unknown_offset}, access_pattern::willneed);
+    REQUIRE(cache.stats().misses == 4);
+    std::byte buf[256];
+    cache.read_at(0, buf);
+    REQUIRE(cache.stats().hits == 4);
+    REQUIRE(cache.stats().misses == 4);
+
+    // dontneed drops the blocks of the range
+    cache.advise({64, 128}, access_pattern::dontneed);
+    cache.read_at(0, buf);
+    REQUIRE(cache.stats().hits == 7);
+    REQUIRE(cache.stats().misses == 5);
+
+    // up to the end of the device
+    cache.advise({960, unknown_offset}, access_pattern::willneed);
+    REQUIRE(cache.stats().misses == 6);
+
+    // a full cache keeps its blocks, hints do not evict them
+    block_cache_device small(device, 4 * 64, 64, 1);
+    small.read_at(0, buf);
+    small.advise({512, unknown_offset}, access_pattern::willneed);
+    REQUIRE(small.stats().misses == 4);
+    small.read_at(0, buf);
+    REQUIRE(small.stats().hits == 4);
+    REQUIRE(small.stats().evictions == 0);
+}
+
+TEST_CASE("test case for block cache pinned views", "[io.cache]")
+{
+    auto device = make_device(1000);
+    ape::io::block_cache_device cache(device, 64, 64, 1);
+    STATIC_REQUIRE(ape::io::read_map<decltype(cache)>);
+
+    auto v = cache.view_rd({70, 120});
+    auto a = ape::io::address(v);
+    REQUIRE(a.size() == 50);
+    REQUIRE(a[0] == std::byte(70));
+
+    // a second view of the same block shares its memory
+    auto v2 = cache.view_rd({64, 128});
+    REQUIRE(ape::io::address(v2).data() + 6 == a.data());
+
+    // evicting the block keeps the pinned memory alive
+    cache.view_rd({500, 510});
+    REQUIRE(cache.stats().evictions == 1);
+    REQUIRE(a[49] == std::byte(119));
+
+    // ranges crossing blocks come back as a copy
+    auto v3 = cache.view_rd({60, 200});
+    auto a3 = ape::io::address(v3);
+    REQUIRE(a3.size() == 140);
+    REQUIRE(a3[139] == std::byte(199));
+
+    ape::error_code ec;
+    cache.view_rd({900, 1100}, ape::error_code_ptr(&ec));
+    REQUIRE(ec);
+}
+
+TEST_CASE("test case for block cache views without size queries", "[io.cache]")
+{
+    sized_device device;
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        auto b = std::byte(i % 251);
+        device.write({&b, 1});
+    }
+    ape::io::block_cache_device cache(device, 4 * 64, 64, 1);
+
+    // ranges within a block are checked against the cached block
+    REQUIRE(ape::io::address(cache.view_rd({70, 120})).size() == 50);
+    REQUIRE(ape::io::address(cache.view_rd({64, 128})).size() == 64);
+    REQUIRE(ape::io::address(cache.view_rd({980, 1000})).size() == 20);
+    REQUIRE(device.size_calls == 0);
+
+    // the last block holds 40 bytes
+    ape::error_code ec;
+    cache.view_rd({990, 1010}, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::invalid_argument);
+    REQUIRE(device.size_calls == 0);
+
+    REQUIRE(ape::io::address(cache.view_rd({960, ape::io::unknown_offset})).size() == 40);
+    REQUIRE(device.size_calls == 1);
+}
+
+TEST_CASE("test case for block cache shared by threads", "[io.cache]")
+{
+    auto device = make_device(1 << 16);
+    ape::io::block_cache_device cache(device, 8 * 1024, 512, 4);
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4);
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            std::byte buf[300];
+            for (std::size_t i = 0; i < 2000; ++i)
+            {
+                auto off = (i * 7919 + std::size_t(t) * 104729) % ((1 << 16) - sizeof(buf));
+                auto got = cache.read_at(off, buf);
+                if (got.size() != sizeof(buf) || got[0] != std::byte(off % 251) ||
+                    got[299] != std::byte((off + 299) % 251))
+                    ++failures[t];
+            }
+        });
+    for (auto &th : threads)
+        th.join();
+
+    for (auto f : failures)
+        REQUIRE(f == 0);
+    auto s = cache.stats();
+    REQUIRE(s.hits + s.misses >= 4 * 2000);
+}
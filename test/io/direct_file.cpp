@@ -0,0 +1,164 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // memory device requiring the alignment of direct io, counting the transfers violating it
+    struct strict_aligned_device : ape::io::memory_device<>
+    {
+        static constexpr std::size_t align = 512;
+        std::size_t violations = 0;
+
+        std::size_t get_option(ape::io::alignment_option) const noexcept { return align; }
+
+        void check(ape::long_size_t off, const std::byte *p, std::size_t n)
+        {
+            if (off % align != 0 || reinterpret_cast<std::uintptr_t>(p) % align != 0 || n % align != 0)
+                ++violations;
+        }
+        ape::io::mutable_buffer read(ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            check(offset(), buf.data(), buf.size());
+            return memory_device::read(buf, ec);
+        }
+        ape::io::const_buffer write(ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            check(offset(), buf.data(), buf.size());
+            return memory_device::write(buf, ec);
+        }
+        ape::io::mutable_buffer read_at(ape::long_size_t off, ape::io::mutable_buffer buf, ape::error_code_ptr ec = {})
+        {
+            check(off, buf.data(), buf.size());
+            return memory_device::read_at(off, buf, ec);
+        }
+        ape::io::const_buffer write_at(ape::long_size_t off, ape::io::const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            check(off, buf.data(), buf.size());
+            return memory_device::write_at(off, buf, ec);
+        }
+    };
+
+    std::vector<std::byte> make_pattern(std::size_t n)
+    {
+        std::vector<std::byte> data(n);
+        for (std::size_t i = 0; i < n; ++i)
+            data[i] = std::byte(i % 251);
+        return data;
+    }
+}
+
+TEST_CASE("test case for aligned allocator", "[io][direct]")
+{
+    std::vector<std::byte, ape::aligned_allocator<std::byte>> v(100);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(v.data()) % 4096 == 0);
+
+    ape::aligned_allocator<std::byte> a512(512);
+    std::vector<std::byte, ape::aligned_allocator<std::byte>> w(a512);
+    w.resize(3000);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(w.data()) % 512 == 0);
+    REQUIRE(w.get_allocator().alignment() == 512);
+    REQUIRE(w.get_allocator() != v.get_allocator());
+
+    // memory device over aligned storage
+    using namespace ape::io;
+    memory_device<aligned_buffer_represent> device;
+    auto data = make_pattern(10000);
+    REQUIRE(device.write(data).empty());
+    auto view = device.view_rd({0, 100});
+    REQUIRE(reinterpret_cast<std::uintptr_t>(address(view).data()) % 4096 == 0);
+}
+
+TEST_CASE("test case for buffered adaptors on aligned devices", "[io][direct]")
+{
+    using namespace ape::io;
+    strict_aligned_device device;
+    auto data = make_pattern(2300);
+    REQUIRE(get_option<alignment_option>(device) == 512);
+
+    {
+        buffered_writer<strict_aligned_device> wr(device, 1000);
+        REQUIRE(wr.block_size() == 1024);
+        for (std::size_t i = 0; i < 2100; i += 7)
+            REQUIRE(wr.write({data.data() + i, 7}).empty());
+        // a large unaligned write goes through the block
+        REQUIRE(wr.write({data.data() + 2100, 150}).empty());
+        wr.flush();
+        REQUIRE(device.size() == 2250);
+        REQUIRE(wr.offset() == 2250);
+        REQUIRE(wr.pending() == 0);
+
+        // the padded tail block is rewritten by later writes
+        REQUIRE(wr.write({data.data() + 2250, 50}).empty());
+        wr.flush();
+        REQUIRE(device.size() == 2300);
+
+        // rewrite in the middle, the rest of the block is kept
+        std::byte ff[10];
+        std::fill(std::begin(ff), std::end(ff), std::byte{0xff});
+        REQUIRE(wr.seek(1000) == 1000);
+        REQUIRE(wr.write(ff).empty());
+    }
+    REQUIRE(device.violations == 0);
+    REQUIRE(device.size() == 2300);
+
+    std::vector<std::byte> out(2300);
+    device.memory_device::read_at(0, out);
+    auto expect = data;
+    std::fill(expect.begin() + 1000, expect.begin() + 1010, std::byte{0xff});
+    REQUIRE(out == expect);
+
+    device.seek(0);
+    buffered_reader<strict_aligned_device> rd(device, 512);
+    std::byte buf[50];
+    REQUIRE(rd.seek(700) == 700);
+    REQUIRE(rd.read(buf).size() == 50);
+    REQUIRE(std::equal(buf, buf + 50, expect.begin() + 700));
+
+    // a large read into an unaligned buffer bounces through the block
+    std::vector<std::byte> big(1601);
+    REQUIRE(rd.read({big.data() + 1, 1600}).size() == 1550);
+    REQUIRE(std::equal(big.begin() + 1, big.begin() + 1551, expect.begin() + 750));
+    REQUIRE(rd.read(buf).empty());
+    REQUIRE(rd.peek(10).empty());
+    REQUIRE(device.violations == 0);
+}
+
+#if __has_include(<unistd.h>)
+#include <filesystem>
+#include <string>
+
+TEST_CASE("test case for io direct file device", "[io][direct]")
+{
+    using namespace ape::io;
+    auto path = (std::filesystem::current_path() / ("ape_estl_direct_" + std::to_string(::getpid()))).string();
+    std::filesystem::remove(path);
+
+    ape::error_code ec;
+    direct_file_device device(path, open_mode::read_write | open_mode::create, ape::error_code_ptr(&ec));
+    if (ec)
+        return; // file system without direct io
+    auto align = get_option<alignment_option>(device);
+    REQUIRE(align >= 1);
+    REQUIRE(get_option<block_size_option>(device) % align == 0);
+
+    auto data = make_pattern(100000);
+    {
+        buffered_writer<direct_file_device> wr(device, 64 * 1024);
+        for (std::size_t i = 0; i < data.size(); i += 1000)
+            REQUIRE(wr.write({data.data() + i, 1000}).empty());
+    }
+    REQUIRE(device.size() == data.size());
+
+    device.seek(0);
+    buffered_reader<direct_file_device> rd(device, 64 * 1024);
+    std::vector<std::byte, ape::aligned_allocator<std::byte>> in(data.size() + align, device.allocator());
+    REQUIRE(rd.seek(3) == 3);
+    REQUIRE(rd.read({in.data(), in.size()}).size() == data.size() - 3);
+    REQUIRE(std::equal(data.begin() + 3, data.end(), in.begin()));
+
+    device.close();
+    std::filesystem::remove(path);
+}
+#endif
@@ -0,0 +1,140 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+
+#if __has_include(<unistd.h>)
+#include <filesystem>
+#include <string>
+
+namespace
+{
+    struct temp_path
+    {
+        std::string path;
+        explicit temp_path(const char *name)
+            : path((std::filesystem::temp_directory_path() /
+                    (std::string("ape_estl_") + name + "_" + std::to_string(::getpid())))
+                       .string())
+        {
+            std::filesystem::remove(path);
+        }
+        ~temp_path()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    };
+}
+
+TEST_CASE("test case for io file device", "[io][file]")
+{
+    using namespace ape::io;
+    static_assert(reader<file_device> && writer<file_device> && ape::io::random<file_device>);
+    static_assert(sizer<file_device> && truncater<file_device> && syncer<file_device> && is_eofer<file_device>);
+    static_assert(vec_reader<file_device> && vec_writer<file_device>);
+
+    temp_path tmp("file_device");
+    file_device device(tmp.path, open_mode::read_write | open_mode::create);
+    REQUIRE(device.is_open());
+    REQUIRE(device.size() == 0);
+    REQUIRE(device.is_eof());
+    REQUIRE(get_option<block_size_option>(device) >= 512);
+
+    std::vector<std::byte> buffer(10, std::byte{42});
+    REQUIRE(device.write(buffer).empty());
+    REQUIRE(device.offset() == 10);
+    REQUIRE(device.size() == 10);
+
+    REQUIRE(device.seek(5) == 5);
+    REQUIRE(device.write(buffer).empty());
+    REQUIRE(device.size() == 15);
+
+    std::vector<std::byte> readin(20);
+    REQUIRE(device.seek(0) == 0);
+    auto got = device.read(readin);
+    REQUIRE(got.size() == 15);
+    REQUIRE(readin[14] == std::byte{42});
+    REQUIRE(device.offset() == 15);
+    REQUIRE(device.is_eof());
+    REQUIRE(device.read(readin).empty());
+
+    REQUIRE(device.truncate(4) == 4);
+    REQUIRE(device.size() == 4);
+    REQUIRE_NOTHROW(device.sync());
+    static_assert(advisor<file_device>);
+    REQUIRE_NOTHROW(device.advise({0, unknown_offset}, access_pattern::sequential));
+    REQUIRE_NOTHROW(advise(device, {0, 4}, access_pattern::dontneed));
+
+    std::vector<std::byte> head(3, std::byte{1}), body(5, std::byte{2});
+    const_buffer out[] = {head, body};
+    REQUIRE(device.seek(0) == 0);
+    REQUIRE(write_vec(device, out) == 8);
+    REQUIRE(device.offset() == 8);
+
+    std::vector<std::byte> a(2), b(10);
+    mutable_buffer in[] = {a, b};
+    REQUIRE(device.seek(0) == 0);
+    REQUIRE(read_vec(device, in) == 8);
+    REQUIRE(a[1] == std::byte{1});
+    REQUIRE(b[0] == std::byte{1});
+    REQUIRE(b[1] == std::byte{2});
+    REQUIRE(device.truncate(4) == 4);
+
+    file_device moved(std::move(device));
+    REQUIRE(!device.is_open());
+    REQUIRE(moved.size() == 4);
+}
+
+TEST_CASE("test case for io file device holes", "[io][file]")
+{
+    using namespace ape::io;
+    static_assert(extent_finder<file_device> && hole_puncher<file_device>);
+    temp_path tmp("file_device_holes");
+    file_device device(tmp.path, open_mode::read_write | open_mode::create);
+
+    std::vector<std::byte> data(1 << 20, std::byte{3});
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.find_data(0) == 0);
+    REQUIRE(device.find_hole(0) == data.size());
+    REQUIRE(device.find_data(data.size()) == data.size());
+
+    ape::error_code ec;
+    device.punch_hole({64 * 1024, 512 * 1024}, ape::error_code_ptr(&ec));
+    if (ec)
+        return; // file system without hole punching
+    REQUIRE(device.size() == data.size());
+    std::vector<std::byte> readin(data.size());
+    REQUIRE(device.read_at(0, readin).size() == data.size());
+    REQUIRE(readin[64 * 1024 - 1] == std::byte{3});
+    REQUIRE(readin[64 * 1024] == std::byte{0});
+    REQUIRE(readin[512 * 1024 - 1] == std::byte{0});
+    REQUIRE(readin[512 * 1024] == std::byte{3});
+
+    // extents are reported at file system block granularity
+    REQUIRE(device.find_hole(0) == 64 * 1024);
+    REQUIRE(device.find_data(64 * 1024) == 512 * 1024);
+    REQUIRE(device.find_hole(512 * 1024) == data.size());
+
+    // growing leaves a hole at the end
+    REQUIRE(device.truncate(4 << 20) == 4 << 20);
+    REQUIRE(device.find_hole(512 * 1024) == data.size());
+    REQUIRE(device.find_data(data.size()) == 4 << 20);
+}
+
+TEST_CASE("test case for io file device errors", "[io][file]")
+{
+    using namespace ape::io;
+    temp_path tmp("file_device_missing");
+
+    ape::error_code ec;
+    file_device device(tmp.path, open_mode::read, ape::error_code_ptr(&ec));
+    REQUIRE(ec);
+    REQUIRE(!device.is_open());
+
+    REQUIRE_THROWS_AS(file_device(tmp.path, open_mode::read), io_exception);
+
+    file_device created(tmp.path, open_mode::write | open_mode::create);
+    std::vector<std::byte> readin(4);
+    created.read(readin, ape::error_code_ptr(&ec));
+    REQUIRE(ec);
+}
+#endif
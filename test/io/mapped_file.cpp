@@ -0,0 +1,69 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+
+#if __has_include(<sys/mman.h>)
+#include <filesystem>
+#include <string>
+
+TEST_CASE("test case for io mapped file device", "[io][mapped_file]")
+{
+    using namespace ape::io;
+    static_assert(read_map<mapped_file_device> && write_map<mapped_file_device>);
+    static_assert(reader<mapped_file_device> && writer<mapped_file_device> && ape::io::random<mapped_file_device>);
+
+    auto path = (std::filesystem::temp_directory_path() /
+                 ("ape_estl_mapped_file_" + std::to_string(::getpid())))
+                    .string();
+    std::filesystem::remove(path);
+
+    {
+        mapped_file_device device(path, open_mode::read_write | open_mode::create);
+        REQUIRE(device.size() == 0);
+        REQUIRE(device.view_rd({0, unknown_offset}).address().empty());
+        // nothing is mapped yet, empty writes must not touch the mapping
+        REQUIRE(device.write(const_buffer{}).empty());
+        REQUIRE(device.write_at(0, const_buffer{}).empty());
+        REQUIRE(device.size() == 0);
+
+        std::vector<std::byte> buffer(10, std::byte{42});
+        REQUIRE(device.write(buffer).empty());
+        REQUIRE(device.size() == 10);
+
+        auto rd = device.view_rd({2, 6});
+        REQUIRE(rd.address().size() == 4);
+        REQUIRE(rd.address()[0] == std::byte{42});
+
+        {
+            auto wr = device.view_wr({8, 20});
+            REQUIRE(wr.address().size() == 12);
+            wr.address()[11] = std::byte{7};
+        }
+        REQUIRE(device.size() == 20);
+
+        // grow far beyond the reservation, the old view stays valid
+        REQUIRE(device.truncate(1 << 20) == (1 << 20));
+        REQUIRE(rd.address()[3] == std::byte{42});
+        REQUIRE(device.truncate(20) == 20);
+        REQUIRE_NOTHROW(device.sync());
+        REQUIRE_NOTHROW(device.advise({0, unknown_offset}, access_pattern::willneed));
+        // dropping the pages of a shared mapping keeps the data
+        REQUIRE_NOTHROW(device.advise({1, 20}, access_pattern::dontneed));
+        REQUIRE(rd.address()[0] == std::byte{42});
+    }
+
+    {
+        mapped_file_device device(path, open_mode::read);
+        REQUIRE(device.size() == 20);
+        std::vector<std::byte> readin(32);
+        REQUIRE(device.read(readin).size() == 20);
+        REQUIRE(readin[0] == std::byte{42});
+        REQUIRE(readin[19] == std::byte{7});
+        REQUIRE(device.is_eof());
+
+        ape::error_code ec;
+        device.write(readin, ape::error_code_ptr(&ec));
+        REQUIRE(ec);
+    }
+    std::filesystem::remove(path);
+}
+#endif
@@ -0,0 +1,138 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE("test case for io latency histogram", "[io][metered]")
+{
+    using ape::io::latency_histogram;
+    STATIC_REQUIRE(latency_histogram::bucket_of(0) == 0);
+    STATIC_REQUIRE(latency_histogram::bucket_of(3) == 3);
+    // 4 linear buckets per power of two
+    STATIC_REQUIRE(latency_histogram::bucket_of(4) == 4);
+    STATIC_REQUIRE(latency_histogram::bucket_of(7) == 7);
+    STATIC_REQUIRE(latency_histogram::bucket_of(8) == 8);
+    STATIC_REQUIRE(latency_histogram::bucket_of(9) == 8);
+    STATIC_REQUIRE(latency_histogram::bucket_of(10) == 9);
+    STATIC_REQUIRE(latency_histogram::bucket_of(~0ull) == latency_histogram::bucket_count - 1);
+
+    for (std::uint64_t ns : {1ull, 5ull, 100ull, 12345ull, 1000000ull, 999999999ull})
+    {
+        auto idx = latency_histogram::bucket_of(ns);
+        REQUIRE(latency_histogram::bucket_floor(idx) <= ns);
+        REQUIRE(latency_histogram::bucket_floor(idx + 1) > ns);
+    }
+
+    latency_histogram h;
+    REQUIRE(h.percentile(50) == 0);
+    h.add(latency_histogram::bucket_of(100), 90);
+    h.add(latency_histogram::bucket_of(10000), 10);
+    REQUIRE(h.total() == 100);
+    REQUIRE(h.percentile(50) == latency_histogram::bucket_floor(latency_histogram::bucket_of(100)));
+    REQUIRE(h.percentile(99) == latency_histogram::bucket_floor(latency_histogram::bucket_of(10000)));
+}
+
+TEST_CASE("test case for io metered device", "[io][metered]")
+{
+    using namespace ape::io;
+    using metered = metered_device<memory_device<>>;
+    static_assert(reader<metered> && writer<metered> && ape::io::random<metered>);
+    static_assert(positional_reader<metered> && positional_writer<metered>);
+    static_assert(vec_reader<metered> && vec_writer<metered>);
+    static_assert(read_map<metered> && write_map<metered>);
+    static_assert(sizer<metered> && truncater<metered> && syncer<metered> && is_eofer<metered>);
+
+    memory_device<> backing;
+    metered device(backing);
+
+    std::byte data[100]{};
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.write_at(200, {data, 50}).empty());
+    device.seek(0);
+    std::byte readin[300];
+    REQUIRE(device.read(readin).size() == 250);
+    REQUIRE(device.read_at(240, readin).size() == 10);
+    device.sync();
+    device.truncate(10);
+
+    auto s = device.snapshot();
+    REQUIRE(s[io_op::write].count == 1);
+    REQUIRE(s[io_op::write].bytes == 100);
+    REQUIRE(s[io_op::write_at].bytes == 50);
+    REQUIRE(s[io_op::read].count == 1);
+    REQUIRE(s[io_op::read].bytes == 250);
+    REQUIRE(s[io_op::read_at].bytes == 10);
+    REQUIRE(s[io_op::seek].count == 1);
+    REQUIRE(s[io_op::sync].count == 1);
+    REQUIRE(s[io_op::truncate].count == 1);
+    REQUIRE(s[io_op::read].latency.total() == 1);
+    REQUIRE(s[io_op::read].errors == 0);
+
+    // snapshots of several devices merge
+    auto twice = s;
+    twice.merge(s);
+    REQUIRE(twice[io_op::read].bytes == 500);
+    REQUIRE(twice[io_op::read].latency.total() == 2);
+
+    device.reset_meter();
+    REQUIRE(device.snapshot()[io_op::read].count == 0);
+}
+
+TEST_CASE("test case for io metered device errors and threads", "[io][metered]")
+{
+    using namespace ape::io;
+
+    struct failing_device : memory_device<>
+    {
+        const_buffer write(const_buffer buf, ape::error_code_ptr ec = {})
+        {
+            ape::set_error_or_throw<io_exception>(ec, std::errc::no_space_on_device);
+            return buf;
+        }
+    };
+    failing_device backing;
+    metered_device<failing_device> device(backing);
+    std::byte data[10]{};
+
+    ape::error_code ec;
+    device.write(data, ape::error_code_ptr(&ec));
+    REQUIRE(ec);
+    REQUIRE_THROWS_AS(device.write(data), io_exception);
+    auto s = device.snapshot();
+    REQUIRE(s[io_op::write].count == 2);
+    REQUIRE(s[io_op::write].errors == 2);
+    REQUIRE(s[io_op::write].bytes == 0);
+
+    // concurrent positional reads from several threads
+    memory_device<> shared;
+    std::byte block[64]{};
+    shared.write(block);
+    metered_device<memory_device<>> reader(shared);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&] {
+            std::byte buf[64];
+            for (int i = 0; i < 1000; ++i)
+                reader.read_at(0, buf);
+        });
+    for (auto &t : threads)
+        t.join();
+    auto rs = reader.snapshot();
+    REQUIRE(rs[io_op::read_at].count == 4000);
+    REQUIRE(rs[io_op::read_at].bytes == 4000 * 64);
+}
+
+TEST_CASE("test case for io metered device disabled", "[io][metered]")
+{
+    using namespace ape::io;
+    using plain = metered_device<memory_device<>, false>;
+    STATIC_REQUIRE(sizeof(plain) == sizeof(void *));
+    static_assert(reader<plain> && writer<plain> && positional_reader<plain>);
+
+    memory_device<> backing;
+    plain device(backing);
+    std::byte data[10]{};
+    REQUIRE(device.write(data).empty());
+    REQUIRE(backing.size() == 10);
+    REQUIRE(device.snapshot()[io_op::write].count == 0);
+}
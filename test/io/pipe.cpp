@@ -0,0 +1,114 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE("test case for io ring pipe", "[io][pipe]")
+{
+    using namespace ape::io;
+    static_assert(writer<ring_pipe_writer> && write_map<ring_pipe_writer> && syncer<ring_pipe_writer>);
+    static_assert(reader<ring_pipe_reader> && read_map<ring_pipe_reader> && forward<ring_pipe_reader>);
+    static_assert(is_eofer<ring_pipe_reader> && sequence<ring_pipe_writer>);
+
+    auto [rd, wr] = make_ring_pipe(100);
+    REQUIRE(wr.capacity() == 128);
+
+    std::byte data[200];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i);
+
+    REQUIRE(wr.write({data, 100}).empty());
+    REQUIRE(wr.offset() == 100);
+    REQUIRE(rd.size() == 100);
+    REQUIRE(!rd.is_eof());
+
+    std::byte readin[200];
+    REQUIRE(rd.read({readin, 60}).size() == 60);
+    REQUIRE(std::equal(readin, readin + 60, data));
+    REQUIRE(rd.offset() == 60);
+
+    // the free space wraps: a view stops at the end of the ring
+    {
+        auto v = wr.view_wr({100, 200});
+        REQUIRE(v.address().size() == 28);
+        std::memcpy(v.address().data(), data + 100, 28);
+    }
+    REQUIRE(wr.offset() == 128);
+    {
+        auto v = wr.view_wr({128, 200});
+        REQUIRE(v.address().size() == 60);
+        std::memcpy(v.address().data(), data + 128, 10);
+        v.commit(10);
+    }
+    REQUIRE(wr.offset() == 138);
+    REQUIRE_THROWS_AS(wr.view_wr({0, 10}), ape::io::io_exception);
+
+    // a read crosses the wrap point
+    REQUIRE(rd.read(readin).size() == 78);
+    REQUIRE(std::equal(readin, readin + 78, data + 60));
+
+    REQUIRE(wr.write({data, 20}).empty());
+    {
+        auto v = rd.view_rd({138, unknown_offset});
+        REQUIRE((v.address().size() == 20));
+        REQUIRE(std::equal(v.address().begin(), v.address().end(), data));
+        v.consume(5);
+    }
+    REQUIRE(rd.offset() == 143);
+    REQUIRE(rd.seek_forward(150) == 150);
+
+    wr.close();
+    REQUIRE(!rd.is_eof());
+    REQUIRE(rd.read(readin).size() == 8);
+    REQUIRE(rd.is_eof());
+    REQUIRE(rd.read(readin).empty());
+    REQUIRE(rd.view_rd({158, unknown_offset}).address().empty());
+}
+
+TEST_CASE("test case for io ring pipe broken pipe", "[io][pipe]")
+{
+    using namespace ape::io;
+    auto [rd, wr] = make_ring_pipe(64);
+    std::byte data[100]{};
+    rd.close();
+    ape::error_code ec;
+    auto rest = wr.write(data, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::broken_pipe);
+    REQUIRE(rest.size() == 36);
+}
+
+TEST_CASE("test case for io ring pipe threads", "[io][pipe]")
+{
+    using namespace ape::io;
+    auto [rd, wr] = make_ring_pipe(4096);
+    constexpr std::size_t total = 1 << 20;
+
+    std::thread producer([&wr = wr] {
+        std::uint32_t next = 0;
+        while (wr.offset() < total)
+        {
+            auto v = wr.view_wr({ape::long_offset_t(wr.offset()), ape::long_offset_t(total)});
+            for (auto &b : v.address())
+                b = std::byte(next++ % 251);
+        }
+        wr.sync();
+        wr.close();
+    });
+
+    std::vector<std::byte> got;
+    std::byte buf[1000];
+    for (;;)
+    {
+        auto r = rd.read(buf);
+        if (r.empty())
+            break;
+        got.insert(got.end(), r.begin(), r.end());
+    }
+    producer.join();
+
+    REQUIRE(got.size() == total);
+    bool ok = true;
+    for (std::size_t i = 0; i < total; ++i)
+        ok = ok && got[i] == std::byte(i % 251);
+    REQUIRE(ok);
+}
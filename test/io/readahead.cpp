@@ -0,0 +1,92 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <vector>
+
+namespace
+{
+    std::vector<std::byte> make_pattern(std::size_t n)
+    {
+        std::vector<std::byte> data(n);
+        for (std::size_t i = 0; i < n; ++i)
+            data[i] = std::byte(i % 251);
+        return data;
+    }
+}
+
+TEST_CASE("test case for io readahead device", "[io][readahead]")
+{
+    using namespace ape::io;
+    memory_device<> backing;
+    auto data = make_pattern(1 << 20);
+    backing.write(data);
+    backing.seek(0);
+
+    using device_type = readahead_device<memory_device<>>;
+    static_assert(reader<device_type> && ape::io::random<device_type> && sizer<device_type> && is_eofer<device_type>);
+    device_type device(backing, 4096, 64 * 1024);
+    REQUIRE(device.size() == data.size());
+
+    // sequential scan turns readahead on and grows the window
+    std::vector<std::byte> got;
+    std::byte buf[1000];
+    for (;;)
+    {
+        auto r = device.read(buf);
+        if (r.empty())
+            break;
+        got.insert(got.end(), r.begin(), r.end());
+        if (got.size() == 3000)
+            REQUIRE(device.is_active());
+    }
+    REQUIRE(got == data);
+    REQUIRE(device.is_eof());
+    auto s = device.stats();
+    REQUIRE(s.direct_reads == 1);
+    REQUIRE(s.fetches > 0);
+    REQUIRE(device.window_size() > 4096);
+    REQUIRE(device.window_size() <= 64 * 1024);
+
+    // random access turns it off
+    device.seek(5000);
+    REQUIRE(device.read({buf, 10}).size() == 10);
+    REQUIRE(!device.is_active());
+    REQUIRE(device.window_size() == 4096);
+    REQUIRE(std::equal(buf, buf + 10, data.begin() + 5000));
+    REQUIRE(device.stats().direct_reads == 2);
+
+    // and it comes back on the next sequential run
+    device.seek(100000);
+    for (int i = 0; i < 10; ++i)
+    {
+        auto r = device.read(buf);
+        REQUIRE(r.size() == sizeof(buf));
+        REQUIRE(std::equal(r.begin(), r.end(), data.begin() + 100000 + i * sizeof(buf)));
+    }
+    REQUIRE(device.is_active());
+    REQUIRE(device.offset() == 100000 + 10 * sizeof(buf));
+}
+
+TEST_CASE("test case for io readahead device over seek and read", "[io][readahead]")
+{
+    using namespace ape::io;
+    memory_device<> backing;
+    auto data = make_pattern(300000);
+    backing.write(data);
+
+    // shift_device has no read_at, the worker seeks the device before filling a window
+    shift_device<memory_device<>> shifted(backing, 1000);
+    shifted.seek(0);
+    readahead_device<shift_device<memory_device<>>> device(shifted, 8192, 32768);
+
+    std::vector<std::byte> got(data.size() - 1000);
+    std::size_t done = 0;
+    while (done < got.size())
+    {
+        auto r = device.read({got.data() + done, std::min<std::size_t>(777, got.size() - done)});
+        REQUIRE(!r.empty());
+        done += r.size();
+    }
+    REQUIRE(std::equal(got.begin(), got.end(), data.begin() + 1000));
+    std::byte extra[10];
+    REQUIRE(device.read(extra).empty());
+}
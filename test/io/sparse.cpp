@@ -0,0 +1,95 @@
+#include <catch2/catch_all.hpp>
+#include <ape/estl/io.hpp>
+#include <vector>
+
+TEST_CASE("test case for io sparse memory device", "[io][sparse]")
+{
+    using namespace ape::io;
+    static_assert(reader<sparse_memory_device> && writer<sparse_memory_device> && ape::io::random<sparse_memory_device>);
+    static_assert(positional_reader<sparse_memory_device> && positional_writer<sparse_memory_device>);
+    static_assert(sizer<sparse_memory_device> && truncater<sparse_memory_device> && syncer<sparse_memory_device>);
+
+    sparse_memory_device device(4096);
+    REQUIRE(device.size() == 0);
+    REQUIRE(device.is_eof());
+
+    // a 100 GB device costs the pages written
+    const ape::long_size_t far = 100ull << 30;
+    std::byte data[6000];
+    for (std::size_t i = 0; i < sizeof(data); ++i)
+        data[i] = std::byte(i % 251 + 1);
+    REQUIRE(device.write_at(far, data).empty());
+    REQUIRE(device.size() == far + sizeof(data));
+    REQUIRE(device.page_count() == 2);
+
+    device.seek(5000);
+    REQUIRE(device.write({data, 10}).empty());
+    REQUIRE(device.offset() == 5010);
+    REQUIRE(device.page_count() == 3);
+
+    std::byte readin[8192];
+    REQUIRE(device.read_at(far - 100, readin).size() == 6100);
+    REQUIRE(readin[99] == std::byte{0});
+    REQUIRE(readin[100] == data[0]);
+    REQUIRE(readin[6099] == data[5999]);
+
+    REQUIRE(device.read_at(4096, {readin, 4096}).size() == 4096);
+    REQUIRE(readin[903] == std::byte{0});
+    REQUIRE(readin[904] == data[0]);
+    REQUIRE(readin[914] == std::byte{0});
+
+    // holes are found without reading them
+    REQUIRE(device.find_data(0) == 4096);
+    REQUIRE(device.find_hole(4096) == 8192);
+    REQUIRE(device.find_data(8192) == far);
+    REQUIRE(device.find_data(far + 10) == far + 10);
+    REQUIRE(device.find_hole(far) == device.size());
+    REQUIRE(device.find_hole(0) == 0);
+
+    // truncating frees pages and zeroes the cut tail
+    REQUIRE(device.truncate(far + 10) == far + 10);
+    REQUIRE(device.page_count() == 2);
+    device.truncate(far + 100);
+    REQUIRE(device.read_at(far, readin).size() == 100);
+    REQUIRE(readin[9] == data[9]);
+    REQUIRE(readin[10] == std::byte{0});
+    device.truncate(0);
+    REQUIRE(device.page_count() == 0);
+    REQUIRE(device.find_data(0) == 0);
+}
+
+TEST_CASE("test case for io sparse memory device punch_hole", "[io][sparse]")
+{
+    using namespace ape::io;
+    static_assert(extent_finder<sparse_memory_device> && hole_puncher<sparse_memory_device>);
+
+    sparse_memory_device device(4096);
+    std::vector<std::byte> data(5 * 4096, std::byte{7});
+    REQUIRE(device.write(data).empty());
+    REQUIRE(device.page_count() == 5);
+
+    // whole pages are freed, the partial ones at both ends zeroed
+    device.punch_hole({1000, 3 * 4096 + 10});
+    REQUIRE(device.page_count() == 3);
+    REQUIRE(device.size() == data.size());
+    REQUIRE(device.find_hole(0) == 4096);
+    REQUIRE(device.find_data(4096) == 3 * 4096);
+
+    std::vector<std::byte> readin(data.size());
+    REQUIRE(device.read_at(0, readin).size() == data.size());
+    REQUIRE(readin[999] == std::byte{7});
+    REQUIRE(readin[1000] == std::byte{0});
+    REQUIRE(readin[3 * 4096 + 9] == std::byte{0});
+    REQUIRE(readin[3 * 4096 + 10] == std::byte{7});
+
+    // the range is clamped to the size
+    punch_hole(device, {4 * 4096, unknown_offset});
+    REQUIRE(device.page_count() == 2);
+    REQUIRE(device.size() == data.size());
+    REQUIRE(device.find_data(3 * 4096 + 10) == 3 * 4096 + 10);
+    REQUIRE(device.find_hole(3 * 4096) == 4 * 4096);
+
+    ape::error_code ec;
+    device.punch_hole({10, 5}, ape::error_code_ptr(&ec));
+    REQUIRE(ec == std::errc::invalid_argument);
+}